@@ -35,6 +35,11 @@
 #if !defined(__XCBM5x0__)
 #include "userport.h"
 #endif
+#ifdef HAVE_BINARY_MONITOR
+#include "monitor.h"
+#endif
+#include "output-graphics.h"
+#include "printer.h"
 
 #ifdef USE_LIBRETRO_VFS
 #undef utf8_to_local_string_alloc
@@ -77,6 +82,8 @@ static unsigned int prev_sound_sample_rate = 0;
 static float prev_aspect_ratio = 0;
 
 bool retro_ui_finalized = false;
+/* Printer driver set up by ui_init_finalize(), the option only applies on restart */
+int retro_printer_driver = PRINTER_DRIVER_NONE;
 
 extern uint8_t mem_ram[];
 #if defined(__X64__) || defined(__X64SC__)
@@ -2659,7 +2666,24 @@ static void retro_set_core_options()
          "vice_printer",
          "System > Printer",
          "Printer",
-         "Output is written to 'saves/" ARCHDEP_PRINTER_DEFAULT_DEV1 "'.",
+         "Text output is written to 'saves/" ARCHDEP_PRINTER_DEFAULT_DEV1 "', graphics printers write each page to a numbered PNG next to it. Graphics printers need their ROM and palette files in 'system/vice/PRINTER'.",
+         NULL,
+         "system",
+         {
+            { "disabled", NULL },
+            { "enabled", "ASCII Text" },
+            { "mps803", "MPS-803 Graphics" },
+            { "nl10", "NL-10 Graphics" },
+            { "1520", "1520 Plotter" },
+            { NULL, NULL },
+         },
+         "disabled"
+      },
+      {
+         "vice_sampler",
+         "System > Sampler Input",
+         "Sampler Input",
+         "Sound for sampler devices is read from 'system/vice/sampler.wav'.",
          NULL,
          "system",
          {
@@ -2683,6 +2707,38 @@ static void retro_set_core_options()
          },
          "enabled"
       },
+      {
+         "vice_log_level",
+         "System > Log Level",
+         "Log Level",
+         "Emulator log messages below this level are dropped before they are formatted.",
+         NULL,
+         "system",
+         {
+            { "debug", "Debug" },
+            { "info", "Info" },
+            { "warn", "Warning" },
+            { "error", "Error" },
+            { NULL, NULL },
+         },
+         "debug"
+      },
+#ifdef HAVE_BINARY_MONITOR
+      {
+         "vice_binary_monitor",
+         "System > Binary Monitor",
+         "Binary Monitor",
+         "Serve the VICE binary monitor protocol on 'saves/vice_monitor.sock' for external debuggers.",
+         NULL,
+         "system",
+         {
+            { "disabled", NULL },
+            { "enabled", NULL },
+            { NULL, NULL },
+         },
+         "disabled"
+      },
+#endif
 #if !defined(__X64DTV__)
       {
          "vice_reset",
@@ -5614,11 +5670,17 @@ static void update_variables(void)
       if (retro_ui_finalized)
       {
 #if 1
-         /* Printer only */
+         /* Printers only */
          if (!strcmp(var.value, "disabled") && vice_opt.VirtualDevices)
+         {
             log_resources_set_int("VirtualDevice4", 0);
+            log_resources_set_int("VirtualDevice6", 0);
+         }
          else if (!strcmp(var.value, "enabled") && !vice_opt.VirtualDevices)
+         {
             log_resources_set_int("VirtualDevice4", 1);
+            log_resources_set_int("VirtualDevice6", 1);
+         }
 #else
          if (!strcmp(var.value, "disabled") && vice_opt.VirtualDevices)
          {
@@ -7055,6 +7117,16 @@ static void update_variables(void)
          request_reload_restart = (opt_read_vicerc != opt_read_vicerc_prev) ? true : request_reload_restart;
    }
 
+   var.key = "vice_log_level";
+   var.value = NULL;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if      (!strcmp(var.value, "info"))  log_set_level(RETRO_LOG_INFO);
+      else if (!strcmp(var.value, "warn"))  log_set_level(RETRO_LOG_WARN);
+      else if (!strcmp(var.value, "error")) log_set_level(RETRO_LOG_ERROR);
+      else                                  log_set_level(RETRO_LOG_DEBUG);
+   }
+
 #if defined(__XSCPU64__)
    var.key = "vice_supercpu_speed_switch";
    var.value = NULL;
@@ -7106,10 +7178,46 @@ static void update_variables(void)
    var.value = NULL;
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      if (!strcmp(var.value, "disabled")) vice_opt.Printer = 0;
-      else                                vice_opt.Printer = 1;
+      if      (!strcmp(var.value, "disabled")) vice_opt.Printer = PRINTER_DRIVER_NONE;
+      else if (!strcmp(var.value, "mps803"))   vice_opt.Printer = PRINTER_DRIVER_MPS803;
+      else if (!strcmp(var.value, "nl10"))     vice_opt.Printer = PRINTER_DRIVER_NL10;
+      else if (!strcmp(var.value, "1520"))     vice_opt.Printer = PRINTER_DRIVER_1520;
+      else                                     vice_opt.Printer = PRINTER_DRIVER_ASCII;
+   }
+
+   var.key = "vice_sampler";
+   var.value = NULL;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      int sampler = (!strcmp(var.value, "enabled")) ? 1 : 0;
+
+      if (retro_ui_finalized && vice_opt.Sampler != sampler)
+      {
+         char sample_name[RETRO_PATH_MAX] = {0};
+         if (sampler)
+            path_join(sample_name, retro_system_data_directory, "sampler.wav");
+         log_resources_set_string("SampleName", sample_name);
+      }
+
+      vice_opt.Sampler = sampler;
    }
 
+#ifdef HAVE_BINARY_MONITOR
+   var.key = "vice_binary_monitor";
+   var.value = NULL;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
+   {
+      if (!strcmp(var.value, "enabled"))
+      {
+         char monitor_path[RETRO_PATH_MAX] = {0};
+         path_join(monitor_path, retro_save_directory, "vice_monitor.sock");
+         monitor_binary_open(monitor_path);
+      }
+      else
+         monitor_binary_close();
+   }
+#endif
+
    /* Mapper */
    /* RetroPad */
    var.key = "vice_mapper_up";
@@ -7870,6 +7978,19 @@ void retro_deinit(void)
    /* Free audio buffer */
    free_output_audio_buffer();
 
+#ifdef HAVE_BINARY_MONITOR
+   /* Close binary monitor socket */
+   monitor_binary_close();
+#endif
+
+   /* Eject the sheets left in graphics printers and write pending pages */
+   if (retro_ui_finalized && retro_printer_driver == PRINTER_DRIVER_1520)
+      printer_formfeed(2);
+   else if (retro_ui_finalized && retro_printer_driver != PRINTER_DRIVER_NONE && retro_printer_driver != PRINTER_DRIVER_ASCII)
+      printer_formfeed(0);
+   retro_printer_driver = PRINTER_DRIVER_NONE;
+   output_graphics_shutdown();
+
    /* 'Reset' troublesome static variables */
    libretro_supports_bitmasks = false;
    libretro_supports_ff_override = false;
@@ -8441,8 +8562,17 @@ void retro_run(void)
    input_poll_cb();
    retro_poll_event();
 
-   /* Main loop */
+#ifdef HAVE_BINARY_MONITOR
+   /* Binary monitor requests */
+   monitor_binary_poll();
+#endif
+
+   /* Main loop, held while the binary monitor has the machine stopped */
+#ifdef HAVE_BINARY_MONITOR
+   while (retro_renderloop && !monitor_binary_stopped())
+#else
    while (retro_renderloop)
+#endif
       maincpu_mainloop();
    retro_renderloop = 1;
    retro_now += 1000000 / retro_refresh;
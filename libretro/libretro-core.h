@@ -166,6 +166,12 @@ extern int crop_id_prev;
 #define CROP_MODE_4_3        5
 #define CROP_MODE_5_4        6
 
+#define PRINTER_DRIVER_NONE   0
+#define PRINTER_DRIVER_ASCII  1
+#define PRINTER_DRIVER_MPS803 2
+#define PRINTER_DRIVER_NL10   3
+#define PRINTER_DRIVER_1520   4
+
 #if defined(__X64__) || defined(__X64SC__) || defined(__X64DTV__) || defined(__X128__) || defined(__XSCPU64__) || defined(__XCBM5x0__)
 /* PAL: 384x272, NTSC: 384x247, VIC-II: 320x200 */
 #include "viciitypes.h"
@@ -273,6 +279,7 @@ struct vice_core_options
    int AttachDevice8Readonly;
    int EasyFlashWriteCRT;
    int Printer;
+   int Sampler;
    int VirtualDevices;
    int DriveTrueEmulation;
    int DriveSoundEmulation;
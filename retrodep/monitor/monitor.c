@@ -505,6 +505,7 @@ monitor_cpu_type_t* monitor_find_cpu_type_from_string(const char *cpu_type)
     return NULL;
 }
 #endif
+#ifndef HAVE_BINARY_MONITOR
 void monitor_init(monitor_interface_t *maincpu_interface_init,
                   monitor_interface_t *drive_interface_init[],
                   monitor_cpu_type_t **asmarray)
@@ -514,6 +515,7 @@ void monitor_init(monitor_interface_t *maincpu_interface_init,
 void monitor_shutdown(void)
 {
 }
+#endif
 
 #if 0
 static int monitor_set_initial_breakpoint(const char *param, void *extra_param)
@@ -744,7 +746,7 @@ void mon_delete_conditional(cond_node_t *cnode)
 
 /* *** WATCHPOINTS *** */
 
-
+#ifndef HAVE_BINARY_MONITOR
 void monitor_watch_push_load_addr(uint16_t addr, MEMSPACE mem)
 {
 }
@@ -752,6 +754,7 @@ void monitor_watch_push_load_addr(uint16_t addr, MEMSPACE mem)
 void monitor_watch_push_store_addr(uint16_t addr, MEMSPACE mem)
 {
 }
+#endif
 #if 0
 static bool watchpoints_check_loads(MEMSPACE mem, unsigned int lastpc, unsigned int pc)
 {
@@ -766,7 +769,7 @@ static bool watchpoints_check_stores(MEMSPACE mem, unsigned int lastpc, unsigned
 
 /* *** CPU INTERFACES *** */
 
-
+#ifndef HAVE_BINARY_MONITOR
 int monitor_force_import(MEMSPACE mem)
 {
     return 0;
@@ -794,14 +797,38 @@ int monitor_check_breakpoints(MEMSPACE mem, uint16_t addr)
 void monitor_check_watchpoints(unsigned int lastpc, unsigned int pc)
 {
 }
+#endif
 
 int monitor_diskspace_dnr(int mem)
 {
+    switch (mem) {
+        case e_disk8_space:
+            return 0;
+        case e_disk9_space:
+            return 1;
+        case e_disk10_space:
+            return 2;
+        case e_disk11_space:
+            return 3;
+    }
+
     return -1;
 }
 
+/* The drive CPUs check their monitor state in this memspace.  */
 int monitor_diskspace_mem(int dnr)
 {
+    switch (dnr) {
+        case 0:
+            return e_disk8_space;
+        case 1:
+            return e_disk9_space;
+        case 2:
+            return e_disk10_space;
+        case 3:
+            return e_disk11_space;
+    }
+
     return 0;
 }
 
@@ -830,9 +857,11 @@ static void monitor_close(int check)
 {
 }
 #endif
+#ifndef HAVE_BINARY_MONITOR
 void monitor_startup(MEMSPACE mem)
 {
 }
+#endif
 #if 0
 static void monitor_trap(uint16_t addr, void *unused_data)
 {
@@ -856,10 +885,12 @@ void mon_update_all_checkpoint_state(void)
 {
 }
 
+#ifndef HAVE_BINARY_MONITOR
 int monitor_is_binary(void)
 {
    return 0;
 }
+#endif
 
 ui_jam_action_t monitor_binary_ui_jam_dialog(const char *format, ...)
 {
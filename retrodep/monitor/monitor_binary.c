@@ -0,0 +1,1671 @@
+/*
+ * monitor_binary.c - Binary monitor protocol on a local socket (libretro).
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/*
+ * Serves a subset of the VICE binary monitor protocol (see
+ * vice/src/monitor/monitor_binary.c for the reference implementation) on a
+ * Unix domain socket, without the text monitor behind it.
+ *
+ * The core polls the socket once per retro_run(). Pending commands are
+ * served at the next instruction boundary of the main CPU, and emulation
+ * continues right after; unlike the stand-alone emulator, a command does not
+ * stop the machine. The machine only stops when a checkpoint with the stop
+ * flag is hit or an instruction step completes. The CPU that stopped then
+ * leaves its loop before the instruction, retro_run() skips the main loop
+ * and commands are served from the poll, until an "exit", "advance
+ * instructions" or "reset" command resumes the machine. A stop in a drive
+ * CPU holds the main CPU at its next instruction boundary.
+ *
+ * Replies are queued and sent as far as the socket takes them, the rest at
+ * the next poll; the frontend is never blocked by the client.
+ *
+ * Supported commands: memory get/set, checkpoint get/set/delete/list/toggle,
+ * registers get/set, advance instructions, keyboard feed, ping, banks and
+ * registers available, exit and reset.
+ */
+
+#include "vice.h"
+
+#ifdef HAVE_BINARY_MONITOR
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "drive.h"
+#include "interrupt.h"
+#include "kbdbuf.h"
+#include "lib.h"
+#include "log.h"
+#include "machine.h"
+#include "monitor.h"
+#include "montypes.h"
+#include "mos6510.h"
+#include "mos6510dtv.h"
+#include "traps.h"
+#include "uiapi.h"
+#include "wdc65816.h"
+
+#define ASC_STX 0x02
+
+#define MON_BINARY_API_VERSION 0x02
+
+#define MON_EVENT_ID 0xffffffff
+
+/* Size of the request header: STX, API version, body length, request ID
+   and command type.  */
+#define MON_HEADER_SIZE 11
+
+/* Refuse requests with a body larger than this.  */
+#define MON_BODY_MAX (1 << 20)
+
+/* Drop a client that leaves more than this unread.  */
+#define MON_TX_MAX (1 << 24)
+
+#define WATCH_MAX 10
+
+#define OP_JSR 0x20
+#define OP_RTI 0x40
+#define OP_RTS 0x60
+
+enum t_binary_command {
+    e_MON_CMD_MEM_GET = 0x01,
+    e_MON_CMD_MEM_SET = 0x02,
+
+    e_MON_CMD_CHECKPOINT_GET = 0x11,
+    e_MON_CMD_CHECKPOINT_SET = 0x12,
+    e_MON_CMD_CHECKPOINT_DELETE = 0x13,
+    e_MON_CMD_CHECKPOINT_LIST = 0x14,
+    e_MON_CMD_CHECKPOINT_TOGGLE = 0x15,
+
+    e_MON_CMD_REGISTERS_GET = 0x31,
+    e_MON_CMD_REGISTERS_SET = 0x32,
+
+    e_MON_CMD_ADVANCE_INSTRUCTIONS = 0x71,
+    e_MON_CMD_KEYBOARD_FEED = 0x72,
+
+    e_MON_CMD_PING = 0x81,
+    e_MON_CMD_BANKS_AVAILABLE = 0x82,
+    e_MON_CMD_REGISTERS_AVAILABLE = 0x83,
+
+    e_MON_CMD_EXIT = 0xaa,
+    e_MON_CMD_RESET = 0xcc
+};
+
+enum t_binary_response {
+    e_MON_RESPONSE_MEM_GET = 0x01,
+    e_MON_RESPONSE_MEM_SET = 0x02,
+
+    e_MON_RESPONSE_CHECKPOINT_INFO = 0x11,
+
+    e_MON_RESPONSE_CHECKPOINT_DELETE = 0x13,
+    e_MON_RESPONSE_CHECKPOINT_LIST = 0x14,
+    e_MON_RESPONSE_CHECKPOINT_TOGGLE = 0x15,
+
+    e_MON_RESPONSE_REGISTER_INFO = 0x31,
+
+    e_MON_RESPONSE_STOPPED = 0x62,
+    e_MON_RESPONSE_RESUMED = 0x63,
+
+    e_MON_RESPONSE_ADVANCE_INSTRUCTIONS = 0x71,
+    e_MON_RESPONSE_KEYBOARD_FEED = 0x72,
+
+    e_MON_RESPONSE_PING = 0x81,
+    e_MON_RESPONSE_BANKS_AVAILABLE = 0x82,
+    e_MON_RESPONSE_REGISTERS_AVAILABLE = 0x83,
+
+    e_MON_RESPONSE_EXIT = 0xaa,
+    e_MON_RESPONSE_RESET = 0xcc
+};
+
+enum t_mon_error {
+    e_MON_ERR_OK = 0x00,
+    e_MON_ERR_OBJECT_MISSING = 0x01,
+    e_MON_ERR_INVALID_MEMSPACE = 0x02,
+    e_MON_ERR_CMD_INVALID_LENGTH = 0x80,
+    e_MON_ERR_INVALID_PARAMETER = 0x81,
+    e_MON_ERR_CMD_INVALID_API_VERSION = 0x82,
+    e_MON_ERR_CMD_INVALID_TYPE = 0x83,
+    e_MON_ERR_CMD_FAILURE = 0x8f
+};
+
+typedef struct binary_command_s {
+    unsigned char *body;
+    uint32_t length;
+    uint32_t request_id;
+    uint8_t type;
+} binary_command_t;
+
+typedef struct binary_checkpoint_s {
+    uint32_t checknum;
+    MEMSPACE mem;
+    uint16_t start_addr;
+    uint16_t end_addr;
+    uint8_t stop;
+    uint8_t enabled;
+    uint8_t op;
+    uint8_t temporary;
+    uint32_t hit_count;
+    struct binary_checkpoint_s *next;
+} binary_checkpoint_t;
+
+typedef struct binary_register_s {
+    uint8_t id;
+    uint8_t bits;
+    const char *name;
+} binary_register_t;
+
+static const binary_register_t registers_6502[] = {
+    { e_A, 8, "A" },
+    { e_X, 8, "X" },
+    { e_Y, 8, "Y" },
+    { e_PC, 16, "PC" },
+    { e_SP, 8, "SP" },
+    { e_FLAGS, 8, "FL" },
+    { e_Rasterline, 16, "LIN" },
+    { e_Cycle, 16, "CYC" },
+    { 0, 0, NULL }
+};
+
+static const binary_register_t registers_65816[] = {
+    { e_A, 8, "A" },
+    { e_B, 8, "B" },
+    { e_C, 16, "C" },
+    { e_X, 16, "X" },
+    { e_Y, 16, "Y" },
+    { e_PC, 16, "PC" },
+    { e_SP, 16, "SP" },
+    { e_DPR, 16, "DPR" },
+    { e_PBR, 8, "PBR" },
+    { e_DBR, 8, "DBR" },
+    { e_FLAGS, 8, "FL" },
+    { e_E, 1, "E" },
+    { e_Rasterline, 16, "LIN" },
+    { e_Cycle, 16, "CYC" },
+    { 0, 0, NULL }
+};
+
+monitor_interface_t *mon_interfaces[NUM_MEMSPACES];
+
+int exit_mon = 0;
+
+static int listen_fd = -1;
+static int connected_fd = -1;
+static char *socket_path = NULL;
+
+static unsigned char *rx_buffer = NULL;
+static size_t rx_length = 0;
+static size_t rx_size = 0;
+
+static unsigned char *tx_buffer = NULL;
+static size_t tx_length = 0;
+static size_t tx_size = 0;
+
+static binary_checkpoint_t *checkpoints = NULL;
+static uint32_t checkpoint_next = 1;
+
+/* Commands are waiting to be served at the next instruction boundary.  */
+static int binmon_pending = 0;
+/* A checkpoint or step asks the machine to stop in this memspace.  */
+static int binmon_stop = 0;
+static MEMSPACE binmon_stop_mem = e_comp_space;
+/* The machine is stopped; CPUs that reach an instruction boundary leave
+   their loop and are held there until it is resumed.  */
+static int binmon_stopped = 0;
+static int binmon_held[NUM_MEMSPACES];
+/* A resumed CPU imports the registers set while it was held, and runs the
+   instruction it was held at without checking it a second time.  */
+static int binmon_resuming[NUM_MEMSPACES];
+static int binmon_skip[NUM_MEMSPACES];
+
+static unsigned int instruction_count = 0;
+static int wait_for_return_level = 0;
+static int skip_jsrs = 0;
+static MEMSPACE step_mem = e_comp_space;
+
+static uint16_t watch_load_array[WATCH_MAX][NUM_MEMSPACES];
+static uint16_t watch_store_array[WATCH_MAX][NUM_MEMSPACES];
+static unsigned int watch_load_count[NUM_MEMSPACES];
+static unsigned int watch_store_count[NUM_MEMSPACES];
+static int watch_enabled[NUM_MEMSPACES];
+
+/* ------------------------------------------------------------------------- */
+
+static unsigned char *write_uint16(uint16_t input, unsigned char *output)
+{
+    output[0] = input & 0xffu;
+    output[1] = (input >> 8) & 0xffu;
+
+    return output + 2;
+}
+
+static unsigned char *write_uint32(uint32_t input, unsigned char *output)
+{
+    output[0] = input & 0xffu;
+    output[1] = (input >> 8) & 0xffu;
+    output[2] = (input >> 16) & 0xffu;
+    output[3] = (input >> 24) & 0xffu;
+
+    return output + 4;
+}
+
+static uint32_t little_endian_to_uint32(const unsigned char *input)
+{
+    return ((uint32_t)input[3] << 24) | ((uint32_t)input[2] << 16) | ((uint32_t)input[1] << 8) | input[0];
+}
+
+static uint16_t little_endian_to_uint16(const unsigned char *input)
+{
+    return (uint16_t)((input[1] << 8) | input[0]);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void binmon_disconnect(void)
+{
+    if (connected_fd >= 0) {
+        close(connected_fd);
+        connected_fd = -1;
+    }
+    rx_length = 0;
+    tx_length = 0;
+}
+
+/* Send as much of the queued replies as the connection takes without
+   blocking; the rest is sent at the next poll.  */
+static void binmon_flush(void)
+{
+    size_t done = 0;
+    int flags = 0;
+
+#ifdef MSG_NOSIGNAL
+    flags = MSG_NOSIGNAL;
+#endif
+
+    while (done < tx_length && connected_fd >= 0) {
+        ssize_t sent = send(connected_fd, tx_buffer + done, tx_length - done, flags);
+
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (sent <= 0) {
+            log_message(LOG_DEFAULT, "Binary monitor: send failed, closing connection.");
+            binmon_disconnect();
+            return;
+        }
+        done += (size_t)sent;
+    }
+
+    if (done) {
+        memmove(tx_buffer, tx_buffer + done, tx_length - done);
+        tx_length -= done;
+    }
+}
+
+static void binmon_transmit(const unsigned char *buffer, size_t length)
+{
+    if (connected_fd < 0) {
+        return;
+    }
+
+    if (tx_length + length > MON_TX_MAX) {
+        log_message(LOG_DEFAULT, "Binary monitor: client does not read replies, closing connection.");
+        binmon_disconnect();
+        return;
+    }
+
+    if (tx_size < tx_length + length) {
+        while (tx_size < tx_length + length) {
+            tx_size = tx_size ? tx_size * 2 : 8192;
+        }
+        tx_buffer = lib_realloc(tx_buffer, tx_size);
+    }
+
+    memcpy(tx_buffer + tx_length, buffer, length);
+    tx_length += length;
+}
+
+static void binmon_response(uint32_t length, uint8_t response_type, uint8_t errorcode, uint32_t request_id, const unsigned char *body)
+{
+    unsigned char response[12];
+
+    response[0] = ASC_STX;
+    response[1] = MON_BINARY_API_VERSION;
+    write_uint32(length, &response[2]);
+    response[6] = response_type;
+    response[7] = errorcode;
+    write_uint32(request_id, &response[8]);
+
+    binmon_transmit(response, sizeof response);
+
+    if (body != NULL && length) {
+        binmon_transmit(body, length);
+    }
+
+    binmon_flush();
+}
+
+static void binmon_error(uint8_t errorcode, uint32_t request_id)
+{
+    binmon_response(0, 0, errorcode, request_id, NULL);
+}
+
+/* Read what is available on the connection, waiting at most timeout ms.
+   Returns -1 when the connection is gone.  */
+static int binmon_receive(int timeout)
+{
+    struct pollfd pfd;
+    ssize_t received;
+
+    if (connected_fd < 0) {
+        return -1;
+    }
+
+    pfd.fd = connected_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    if (poll(&pfd, 1, timeout) <= 0) {
+        return 0;
+    }
+
+    if (rx_size - rx_length < 4096) {
+        rx_size = rx_size ? rx_size * 2 : 8192;
+        rx_buffer = lib_realloc(rx_buffer, rx_size);
+    }
+
+    received = recv(connected_fd, rx_buffer + rx_length, rx_size - rx_length - 1, 0);
+    if (received <= 0) {
+        if (received < 0 && (errno == EINTR || errno == EAGAIN)) {
+            return 0;
+        }
+        log_message(LOG_DEFAULT, "Binary monitor: connection closed.");
+        binmon_disconnect();
+        return -1;
+    }
+    rx_length += (size_t)received;
+
+    return 0;
+}
+
+/* Returns the size of the first complete request in the receive buffer, or
+   0 if there is none yet. Garbage before a request is skipped.  */
+static size_t binmon_command_available(void)
+{
+    uint32_t body_length;
+    size_t skip = 0;
+
+    while (skip < rx_length && rx_buffer[skip] != ASC_STX) {
+        ++skip;
+    }
+    if (skip) {
+        memmove(rx_buffer, rx_buffer + skip, rx_length - skip);
+        rx_length -= skip;
+    }
+
+    if (rx_length < MON_HEADER_SIZE) {
+        return 0;
+    }
+
+    body_length = little_endian_to_uint32(&rx_buffer[2]);
+    if (body_length > MON_BODY_MAX) {
+        log_message(LOG_DEFAULT, "Binary monitor: request body of %u bytes refused.", body_length);
+        binmon_disconnect();
+        return 0;
+    }
+
+    if (rx_length < MON_HEADER_SIZE + body_length) {
+        /* Make room for the rest, plus a terminator for string bodies.  */
+        if (rx_size < MON_HEADER_SIZE + body_length + 1) {
+            rx_size = MON_HEADER_SIZE + body_length + 1;
+            rx_buffer = lib_realloc(rx_buffer, rx_size);
+        }
+        return 0;
+    }
+
+    return MON_HEADER_SIZE + body_length;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static MEMSPACE get_requested_memspace(uint8_t requested_memspace)
+{
+    MEMSPACE mem;
+
+    if (requested_memspace > 4) {
+        return e_invalid_space;
+    }
+
+    mem = (MEMSPACE)(e_comp_space + requested_memspace);
+
+    return mon_interfaces[mem] ? mem : e_invalid_space;
+}
+
+static uint8_t memspace_to_uint8_t(MEMSPACE mem)
+{
+    return (uint8_t)(mem - e_comp_space);
+}
+
+static int bank_is_valid(MEMSPACE mem, int bank)
+{
+    const int *banknums;
+
+    if (!mon_interfaces[mem]->mem_bank_list_nos) {
+        return bank == 0;
+    }
+
+    for (banknums = mon_interfaces[mem]->mem_bank_list_nos(); *banknums >= 0; banknums++) {
+        if (*banknums == bank) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static uint8_t binmon_peek(MEMSPACE mem, int bank, uint16_t addr, int sidefx)
+{
+    monitor_interface_t *mi = mon_interfaces[mem];
+
+    if (sidefx || !mi->mem_bank_peek) {
+        return mi->mem_bank_read(bank, addr, mi->context);
+    }
+
+    return mi->mem_bank_peek(bank, addr, mi->context);
+}
+
+static void binmon_poke(MEMSPACE mem, int bank, uint16_t addr, uint8_t value, int sidefx)
+{
+    monitor_interface_t *mi = mon_interfaces[mem];
+
+    if (sidefx || !mi->mem_bank_poke) {
+        mi->mem_bank_write(bank, addr, value, mi->context);
+    } else {
+        mi->mem_bank_poke(bank, addr, value, mi->context);
+    }
+}
+
+/* Drive memory is only current once the drive CPU has caught up.  */
+static void binmon_sync(MEMSPACE mem)
+{
+    if (mem != e_comp_space) {
+        drive_cpu_execute_all(maincpu_clk);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const binary_register_t *register_list(MEMSPACE mem)
+{
+    monitor_interface_t *mi = mon_interfaces[mem];
+
+    if (mi->cpu_regs || mi->dtv_cpu_regs) {
+        return registers_6502;
+    }
+    if (mi->cpu_65816_regs) {
+        return registers_65816;
+    }
+
+    return NULL;
+}
+
+static int register_is_valid(MEMSPACE mem, uint8_t id)
+{
+    const binary_register_t *reg = register_list(mem);
+
+    for (; reg && reg->name; reg++) {
+        if (reg->id == id) {
+            if (id == e_Rasterline || id == e_Cycle) {
+                return mem == e_comp_space && mon_interfaces[mem]->get_line_cycle;
+            }
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static unsigned int register_get(MEMSPACE mem, uint8_t id)
+{
+    monitor_interface_t *mi = mon_interfaces[mem];
+
+    if (id == e_Rasterline || id == e_Cycle) {
+        unsigned int line = 0, cycle = 0;
+        int half_cycle;
+
+        mi->get_line_cycle(&line, &cycle, &half_cycle);
+
+        return id == e_Rasterline ? line : cycle;
+    }
+
+    if (mi->cpu_regs) {
+        mos6510_regs_t *regs = mi->cpu_regs;
+
+        switch (id) {
+            case e_A: return MOS6510_REGS_GET_A(regs);
+            case e_X: return MOS6510_REGS_GET_X(regs);
+            case e_Y: return MOS6510_REGS_GET_Y(regs);
+            case e_PC: return MOS6510_REGS_GET_PC(regs);
+            case e_SP: return MOS6510_REGS_GET_SP(regs);
+            case e_FLAGS: return MOS6510_REGS_GET_STATUS(regs);
+        }
+    } else if (mi->dtv_cpu_regs) {
+        mos6510dtv_regs_t *regs = mi->dtv_cpu_regs;
+
+        switch (id) {
+            case e_A: return MOS6510DTV_REGS_GET_A(regs);
+            case e_X: return MOS6510DTV_REGS_GET_X(regs);
+            case e_Y: return MOS6510DTV_REGS_GET_Y(regs);
+            case e_PC: return MOS6510DTV_REGS_GET_PC(regs);
+            case e_SP: return MOS6510DTV_REGS_GET_SP(regs);
+            case e_FLAGS: return MOS6510DTV_REGS_GET_STATUS(regs);
+        }
+    } else if (mi->cpu_65816_regs) {
+        WDC65816_regs_t *regs = mi->cpu_65816_regs;
+
+        switch (id) {
+            case e_A: return WDC65816_REGS_GET_A(regs);
+            case e_B: return WDC65816_REGS_GET_B(regs);
+            case e_C: return (WDC65816_REGS_GET_B(regs) << 8) | WDC65816_REGS_GET_A(regs);
+            case e_X: return WDC65816_REGS_GET_X(regs);
+            case e_Y: return WDC65816_REGS_GET_Y(regs);
+            case e_PC: return WDC65816_REGS_GET_PC(regs);
+            case e_SP: return WDC65816_REGS_GET_SP(regs);
+            case e_DPR: return WDC65816_REGS_GET_DPR(regs);
+            case e_PBR: return WDC65816_REGS_GET_PBR(regs);
+            case e_DBR: return WDC65816_REGS_GET_DBR(regs);
+            case e_FLAGS: return WDC65816_REGS_GET_STATUS(regs);
+            case e_E: return WDC65816_REGS_GET_EMUL(regs);
+        }
+    }
+
+    return 0;
+}
+
+static void register_set(MEMSPACE mem, uint8_t id, uint16_t val)
+{
+    monitor_interface_t *mi = mon_interfaces[mem];
+
+    if (mi->cpu_regs) {
+        mos6510_regs_t *regs = mi->cpu_regs;
+
+        switch (id) {
+            case e_A: MOS6510_REGS_SET_A(regs, (uint8_t)val); break;
+            case e_X: MOS6510_REGS_SET_X(regs, (uint8_t)val); break;
+            case e_Y: MOS6510_REGS_SET_Y(regs, (uint8_t)val); break;
+            case e_PC: MOS6510_REGS_SET_PC(regs, val); break;
+            case e_SP: MOS6510_REGS_SET_SP(regs, (uint8_t)val); break;
+            case e_FLAGS: MOS6510_REGS_SET_STATUS(regs, (uint8_t)val); break;
+        }
+    } else if (mi->dtv_cpu_regs) {
+        mos6510dtv_regs_t *regs = mi->dtv_cpu_regs;
+
+        switch (id) {
+            case e_A: MOS6510DTV_REGS_SET_A(regs, (uint8_t)val); break;
+            case e_X: MOS6510DTV_REGS_SET_X(regs, (uint8_t)val); break;
+            case e_Y: MOS6510DTV_REGS_SET_Y(regs, (uint8_t)val); break;
+            case e_PC: MOS6510DTV_REGS_SET_PC(regs, val); break;
+            case e_SP: MOS6510DTV_REGS_SET_SP(regs, (uint8_t)val); break;
+            case e_FLAGS: MOS6510DTV_REGS_SET_STATUS(regs, (uint8_t)val); break;
+        }
+    } else if (mi->cpu_65816_regs) {
+        WDC65816_regs_t *regs = mi->cpu_65816_regs;
+
+        switch (id) {
+            case e_A: WDC65816_REGS_SET_A(regs, (uint8_t)val); break;
+            case e_B: WDC65816_REGS_SET_B(regs, (uint8_t)val); break;
+            case e_C:
+                WDC65816_REGS_SET_A(regs, (uint8_t)val);
+                WDC65816_REGS_SET_B(regs, (uint8_t)(val >> 8));
+                break;
+            case e_X: WDC65816_REGS_SET_X(regs, val); break;
+            case e_Y: WDC65816_REGS_SET_Y(regs, val); break;
+            case e_PC: WDC65816_REGS_SET_PC(regs, val); break;
+            case e_SP: WDC65816_REGS_SET_SP(regs, val); break;
+            case e_DPR: WDC65816_REGS_SET_DPR(regs, val); break;
+            case e_PBR: WDC65816_REGS_SET_PBR(regs, (uint8_t)val); break;
+            case e_DBR: WDC65816_REGS_SET_DBR(regs, (uint8_t)val); break;
+            case e_FLAGS: WDC65816_REGS_SET_STATUS(regs, (uint8_t)val); break;
+            case e_E: WDC65816_REGS_SET_EMUL(regs, (uint8_t)(val & 1)); break;
+        }
+    }
+}
+
+static void binmon_response_register_info(uint32_t request_id, MEMSPACE mem)
+{
+    const binary_register_t *reg;
+    unsigned char response[2 + 32 * 4];
+    unsigned char *cursor = response + 2;
+    uint16_t count = 0;
+
+    for (reg = register_list(mem); reg && reg->name; reg++) {
+        if (!register_is_valid(mem, reg->id)) {
+            continue;
+        }
+        *cursor++ = 3;
+        *cursor++ = reg->id;
+        cursor = write_uint16((uint16_t)register_get(mem, reg->id), cursor);
+        ++count;
+    }
+    write_uint16(count, response);
+
+    binmon_response((uint32_t)(cursor - response), e_MON_RESPONSE_REGISTER_INFO, e_MON_ERR_OK, request_id, response);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static binary_checkpoint_t *checkpoint_find(uint32_t checknum)
+{
+    binary_checkpoint_t *cp;
+
+    for (cp = checkpoints; cp; cp = cp->next) {
+        if (cp->checknum == checknum) {
+            return cp;
+        }
+    }
+
+    return NULL;
+}
+
+static void checkpoint_delete(uint32_t checknum)
+{
+    binary_checkpoint_t **link = &checkpoints;
+
+    while (*link) {
+        if ((*link)->checknum == checknum) {
+            binary_checkpoint_t *cp = *link;
+            *link = cp->next;
+            lib_free(cp);
+            return;
+        }
+        link = &(*link)->next;
+    }
+}
+
+static void binmon_response_checkpoint_info(uint32_t request_id, binary_checkpoint_t *cp, int hit)
+{
+    unsigned char response[23];
+
+    write_uint32(cp->checknum, response);
+    response[4] = (uint8_t)hit;
+    write_uint16(cp->start_addr, &response[5]);
+    write_uint16(cp->end_addr, &response[7]);
+    response[9] = cp->stop;
+    response[10] = cp->enabled;
+    response[11] = cp->op;
+    response[12] = cp->temporary;
+    write_uint32(cp->hit_count, &response[13]);
+    write_uint32(0, &response[17]);
+    response[21] = 0;
+    response[22] = memspace_to_uint8_t(cp->mem);
+
+    binmon_response(sizeof response, e_MON_RESPONSE_CHECKPOINT_INFO, e_MON_ERR_OK, request_id, response);
+}
+
+/* Recompute what the CPUs have to report to the monitor.  */
+static void binmon_update_masks(void)
+{
+    int mem;
+
+    for (mem = FIRST_SPACE; mem <= LAST_SPACE; mem++) {
+        monitor_interface_t *mi = mon_interfaces[mem];
+        binary_checkpoint_t *cp;
+        unsigned int mask = MI_NONE;
+        int watch = 0;
+
+        if (!mi) {
+            continue;
+        }
+
+        for (cp = checkpoints; cp; cp = cp->next) {
+            if (cp->enabled && cp->mem == (MEMSPACE)mem) {
+                if (cp->op & e_exec) {
+                    mask |= MI_BREAK;
+                }
+                if (cp->op & (e_load | e_store)) {
+                    watch = 1;
+                }
+            }
+        }
+        if (watch) {
+            mask |= MI_WATCH;
+        }
+        if (instruction_count && step_mem == (MEMSPACE)mem) {
+            mask |= MI_STEP;
+        }
+        /* Commands are served, and a stop in a drive CPU holds the main
+           CPU, at its next instruction boundary; the trap exports its
+           registers there and imports them again on resume.  */
+        if ((binmon_pending || binmon_stopped) && mem == e_comp_space) {
+            mask |= MI_BREAK;
+        }
+
+        if (watch != watch_enabled[mem] && mi->toggle_watchpoints_func) {
+            mi->toggle_watchpoints_func(watch, mi->context);
+            watch_enabled[mem] = watch;
+        }
+
+        monitor_mask[mem] = mask;
+        if (!mask) {
+            binmon_skip[mem] = 0;
+        }
+        if (mask || binmon_resuming[mem]) {
+            interrupt_monitor_trap_on(mi->int_status);
+        } else {
+            interrupt_monitor_trap_off(mi->int_status);
+        }
+    }
+}
+
+/* A checkpoint was hit: report it, and stop if it asks for it.  */
+static void checkpoint_hit(binary_checkpoint_t *cp)
+{
+    cp->hit_count++;
+
+    binmon_response_checkpoint_info(MON_EVENT_ID, cp, 1);
+
+    if (cp->stop) {
+        binmon_stop = 1;
+        binmon_stop_mem = cp->mem;
+    }
+    if (cp->temporary) {
+        checkpoint_delete(cp->checknum);
+        binmon_update_masks();
+    }
+}
+
+static int checkpoints_check(MEMSPACE mem, uint16_t addr, uint8_t op)
+{
+    binary_checkpoint_t *cp = checkpoints;
+
+    while (cp) {
+        binary_checkpoint_t *next = cp->next;
+
+        if (cp->enabled && cp->mem == mem && (cp->op & op)
+            && addr >= cp->start_addr && addr <= cp->end_addr) {
+            checkpoint_hit(cp);
+        }
+        cp = next;
+    }
+
+    return binmon_stop;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void binmon_process_mem_get(binary_command_t *command)
+{
+    unsigned char *body = command->body;
+    unsigned char *response;
+    uint16_t startaddress, endaddress;
+    uint32_t length, i;
+    MEMSPACE mem;
+    int bank;
+
+    if (command->length < 8) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    startaddress = little_endian_to_uint16(&body[1]);
+    endaddress = little_endian_to_uint16(&body[3]);
+    mem = get_requested_memspace(body[5]);
+    bank = little_endian_to_uint16(&body[6]);
+
+    if (startaddress > endaddress) {
+        binmon_error(e_MON_ERR_INVALID_PARAMETER, command->request_id);
+        return;
+    }
+    if (mem == e_invalid_space) {
+        binmon_error(e_MON_ERR_INVALID_MEMSPACE, command->request_id);
+        return;
+    }
+    if (!bank_is_valid(mem, bank)) {
+        binmon_error(e_MON_ERR_INVALID_PARAMETER, command->request_id);
+        return;
+    }
+
+    binmon_sync(mem);
+
+    length = (uint32_t)endaddress - startaddress + 1;
+    response = lib_malloc(2 + length);
+    write_uint16((uint16_t)length, response);
+    for (i = 0; i < length; i++) {
+        response[2 + i] = binmon_peek(mem, bank, (uint16_t)(startaddress + i), body[0]);
+    }
+
+    binmon_response(2 + length, e_MON_RESPONSE_MEM_GET, e_MON_ERR_OK, command->request_id, response);
+
+    lib_free(response);
+}
+
+static void binmon_process_mem_set(binary_command_t *command)
+{
+    const uint32_t header_size = 8;
+    unsigned char *body = command->body;
+    uint16_t startaddress, endaddress;
+    uint32_t length, i;
+    MEMSPACE mem;
+    int bank;
+
+    if (command->length < header_size) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    startaddress = little_endian_to_uint16(&body[1]);
+    endaddress = little_endian_to_uint16(&body[3]);
+    mem = get_requested_memspace(body[5]);
+    bank = little_endian_to_uint16(&body[6]);
+    length = (uint32_t)endaddress - startaddress + 1;
+
+    if (startaddress > endaddress) {
+        binmon_error(e_MON_ERR_INVALID_PARAMETER, command->request_id);
+        return;
+    }
+    if (command->length < header_size + length) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+    if (mem == e_invalid_space) {
+        binmon_error(e_MON_ERR_INVALID_MEMSPACE, command->request_id);
+        return;
+    }
+    if (!bank_is_valid(mem, bank)) {
+        binmon_error(e_MON_ERR_INVALID_PARAMETER, command->request_id);
+        return;
+    }
+
+    binmon_sync(mem);
+
+    for (i = 0; i < length; i++) {
+        binmon_poke(mem, bank, (uint16_t)(startaddress + i), body[header_size + i], body[0]);
+    }
+
+    binmon_response(0, e_MON_RESPONSE_MEM_SET, e_MON_ERR_OK, command->request_id, NULL);
+}
+
+static void binmon_process_checkpoint_get(binary_command_t *command)
+{
+    binary_checkpoint_t *cp;
+
+    if (command->length < 4) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    cp = checkpoint_find(little_endian_to_uint32(command->body));
+    if (!cp) {
+        binmon_error(e_MON_ERR_OBJECT_MISSING, command->request_id);
+        return;
+    }
+
+    binmon_response_checkpoint_info(command->request_id, cp, 0);
+}
+
+static void binmon_process_checkpoint_set(binary_command_t *command)
+{
+    unsigned char *body = command->body;
+    binary_checkpoint_t *cp, **link;
+    MEMSPACE mem = e_comp_space;
+
+    if (command->length < 8) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+    if (command->length >= 9) {
+        mem = get_requested_memspace(body[8]);
+        if (mem == e_invalid_space) {
+            binmon_error(e_MON_ERR_INVALID_MEMSPACE, command->request_id);
+            return;
+        }
+    }
+    if (!(body[6] & (e_load | e_store | e_exec))) {
+        binmon_error(e_MON_ERR_INVALID_PARAMETER, command->request_id);
+        return;
+    }
+
+    cp = lib_calloc(1, sizeof(binary_checkpoint_t));
+    cp->checknum = checkpoint_next++;
+    cp->mem = mem;
+    cp->start_addr = little_endian_to_uint16(&body[0]);
+    cp->end_addr = little_endian_to_uint16(&body[2]);
+    if (cp->end_addr < cp->start_addr) {
+        cp->end_addr = cp->start_addr;
+    }
+    cp->stop = !!body[4];
+    cp->enabled = !!body[5];
+    cp->op = body[6] & (e_load | e_store | e_exec);
+    cp->temporary = !!body[7];
+
+    /* Keep the list in creation order for listing.  */
+    for (link = &checkpoints; *link; link = &(*link)->next) {
+    }
+    *link = cp;
+
+    binmon_update_masks();
+
+    binmon_response_checkpoint_info(command->request_id, cp, 0);
+}
+
+static void binmon_process_checkpoint_delete(binary_command_t *command)
+{
+    uint32_t checknum;
+
+    if (command->length < 4) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    checknum = little_endian_to_uint32(command->body);
+    if (!checkpoint_find(checknum)) {
+        binmon_error(e_MON_ERR_OBJECT_MISSING, command->request_id);
+        return;
+    }
+
+    checkpoint_delete(checknum);
+    binmon_update_masks();
+
+    binmon_response(0, e_MON_RESPONSE_CHECKPOINT_DELETE, e_MON_ERR_OK, command->request_id, NULL);
+}
+
+static void binmon_process_checkpoint_list(binary_command_t *command)
+{
+    unsigned char response[4];
+    binary_checkpoint_t *cp;
+    uint32_t count = 0;
+
+    for (cp = checkpoints; cp; cp = cp->next) {
+        binmon_response_checkpoint_info(command->request_id, cp, 0);
+        ++count;
+    }
+
+    write_uint32(count, response);
+
+    binmon_response(sizeof response, e_MON_RESPONSE_CHECKPOINT_LIST, e_MON_ERR_OK, command->request_id, response);
+}
+
+static void binmon_process_checkpoint_toggle(binary_command_t *command)
+{
+    binary_checkpoint_t *cp;
+
+    if (command->length < 5) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    cp = checkpoint_find(little_endian_to_uint32(command->body));
+    if (!cp) {
+        binmon_error(e_MON_ERR_OBJECT_MISSING, command->request_id);
+        return;
+    }
+
+    cp->enabled = !!command->body[4];
+    binmon_update_masks();
+
+    binmon_response(0, e_MON_RESPONSE_CHECKPOINT_TOGGLE, e_MON_ERR_OK, command->request_id, NULL);
+}
+
+static void binmon_process_registers_get(binary_command_t *command)
+{
+    MEMSPACE mem;
+
+    if (command->length < 1) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    mem = get_requested_memspace(command->body[0]);
+    if (mem == e_invalid_space || !register_list(mem)) {
+        binmon_error(e_MON_ERR_INVALID_MEMSPACE, command->request_id);
+        return;
+    }
+
+    binmon_response_register_info(command->request_id, mem);
+}
+
+static void binmon_process_registers_set(binary_command_t *command)
+{
+    unsigned char *body = command->body;
+    unsigned char *cursor;
+    uint32_t end = command->length;
+    uint16_t count, i;
+    MEMSPACE mem;
+
+    if (command->length < 3) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    mem = get_requested_memspace(body[0]);
+    count = little_endian_to_uint16(&body[1]);
+
+    if (mem == e_invalid_space || !register_list(mem)) {
+        binmon_error(e_MON_ERR_INVALID_MEMSPACE, command->request_id);
+        return;
+    }
+
+    /* Validate all items before changing anything.  */
+    cursor = body + 3;
+    for (i = 0; i < count; i++) {
+        if ((uint32_t)(cursor - body) + 4 > end || cursor[0] < 3) {
+            binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+            return;
+        }
+        if (!register_is_valid(mem, cursor[1])
+            || cursor[1] == e_Rasterline || cursor[1] == e_Cycle) {
+            binmon_error(e_MON_ERR_OBJECT_MISSING, command->request_id);
+            return;
+        }
+        cursor += cursor[0] + 1;
+    }
+
+    cursor = body + 3;
+    for (i = 0; i < count; i++) {
+        register_set(mem, cursor[1], little_endian_to_uint16(&cursor[2]));
+        cursor += cursor[0] + 1;
+    }
+
+    binmon_response_register_info(command->request_id, mem);
+}
+
+static void binmon_process_advance_instructions(binary_command_t *command)
+{
+    monitor_interface_t *mi = mon_interfaces[e_comp_space];
+    uint16_t count;
+
+    if (command->length < 3) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    count = little_endian_to_uint16(&command->body[1]);
+
+    step_mem = e_comp_space;
+    instruction_count = count ? count : 1;
+    skip_jsrs = !!command->body[0];
+    wait_for_return_level = 0;
+    if (skip_jsrs && mi->cpu_regs
+        && binmon_peek(e_comp_space, 0, (uint16_t)register_get(e_comp_space, e_PC), 0) == OP_JSR) {
+        wait_for_return_level = 1;
+    }
+    exit_mon = 1;
+
+    binmon_update_masks();
+
+    binmon_response(0, e_MON_RESPONSE_ADVANCE_INSTRUCTIONS, e_MON_ERR_OK, command->request_id, NULL);
+}
+
+static void binmon_process_keyboard_feed(binary_command_t *command)
+{
+    unsigned char *body = command->body;
+    char *text;
+
+    if (command->length < 1 || command->length < 1u + body[0]) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    /* The byte after the string may already belong to the next request,
+       so terminate a copy instead of the receive buffer.  */
+    text = lib_malloc(body[0] + 1);
+    memcpy(text, &body[1], body[0]);
+    text[body[0]] = '\0';
+
+    kbdbuf_feed(text);
+    lib_free(text);
+
+    binmon_response(0, e_MON_RESPONSE_KEYBOARD_FEED, e_MON_ERR_OK, command->request_id, NULL);
+}
+
+static void binmon_process_banks_available(binary_command_t *command)
+{
+    monitor_interface_t *mi = mon_interfaces[e_comp_space];
+    const int *banknums;
+    const char **banknames;
+    unsigned char *response, *cursor;
+    uint32_t response_size = 2;
+    uint16_t count = 0, i;
+
+    if (!mi->mem_bank_list || !mi->mem_bank_list_nos) {
+        binmon_error(e_MON_ERR_CMD_FAILURE, command->request_id);
+        return;
+    }
+
+    banknums = mi->mem_bank_list_nos();
+    banknames = mi->mem_bank_list();
+
+    for (; banknames[count]; count++) {
+        response_size += 4 + (uint32_t)strlen(banknames[count]);
+    }
+
+    response = lib_malloc(response_size);
+    cursor = write_uint16(count, response);
+    for (i = 0; i < count; i++) {
+        size_t length = strlen(banknames[i]);
+
+        *cursor++ = (uint8_t)(length + 3);
+        cursor = write_uint16((uint16_t)banknums[i], cursor);
+        *cursor++ = (uint8_t)length;
+        memcpy(cursor, banknames[i], length);
+        cursor += length;
+    }
+
+    binmon_response(response_size, e_MON_RESPONSE_BANKS_AVAILABLE, e_MON_ERR_OK, command->request_id, response);
+
+    lib_free(response);
+}
+
+static void binmon_process_registers_available(binary_command_t *command)
+{
+    const binary_register_t *reg;
+    unsigned char response[2 + 32 * 8];
+    unsigned char *cursor = response + 2;
+    uint16_t count = 0;
+    MEMSPACE mem;
+
+    if (command->length < 1) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    mem = get_requested_memspace(command->body[0]);
+    if (mem == e_invalid_space || !register_list(mem)) {
+        binmon_error(e_MON_ERR_INVALID_MEMSPACE, command->request_id);
+        return;
+    }
+
+    for (reg = register_list(mem); reg->name; reg++) {
+        size_t length = strlen(reg->name);
+
+        if (!register_is_valid(mem, reg->id)) {
+            continue;
+        }
+        *cursor++ = (uint8_t)(length + 3);
+        *cursor++ = reg->id;
+        *cursor++ = reg->bits;
+        *cursor++ = (uint8_t)length;
+        memcpy(cursor, reg->name, length);
+        cursor += length;
+        ++count;
+    }
+    write_uint16(count, response);
+
+    binmon_response((uint32_t)(cursor - response), e_MON_RESPONSE_REGISTERS_AVAILABLE, e_MON_ERR_OK, command->request_id, response);
+}
+
+static void binmon_process_reset(binary_command_t *command)
+{
+    if (command->length < 1) {
+        binmon_error(e_MON_ERR_CMD_INVALID_LENGTH, command->request_id);
+        return;
+    }
+
+    if (command->body[0] > 1) {
+        /* Drive resets are not supported.  */
+        binmon_error(e_MON_ERR_INVALID_PARAMETER, command->request_id);
+        return;
+    }
+
+    machine_trigger_reset(command->body[0] ? MACHINE_RESET_MODE_HARD : MACHINE_RESET_MODE_SOFT);
+    exit_mon = 1;
+
+    binmon_response(0, e_MON_RESPONSE_RESET, e_MON_ERR_OK, command->request_id, NULL);
+}
+
+static void binmon_process_command(unsigned char *pbuffer)
+{
+    binary_command_t command;
+    uint8_t api_version = pbuffer[1];
+
+    command.length = little_endian_to_uint32(&pbuffer[2]);
+    command.request_id = little_endian_to_uint32(&pbuffer[6]);
+    command.type = pbuffer[10];
+    command.body = &pbuffer[MON_HEADER_SIZE];
+
+    if (api_version < 0x01 || api_version > 0x02) {
+        binmon_error(e_MON_ERR_CMD_INVALID_API_VERSION, command.request_id);
+        return;
+    }
+
+    switch (command.type) {
+        case e_MON_CMD_PING:
+            binmon_response(0, e_MON_RESPONSE_PING, e_MON_ERR_OK, command.request_id, NULL);
+            break;
+        case e_MON_CMD_MEM_GET:
+            binmon_process_mem_get(&command);
+            break;
+        case e_MON_CMD_MEM_SET:
+            binmon_process_mem_set(&command);
+            break;
+        case e_MON_CMD_CHECKPOINT_GET:
+            binmon_process_checkpoint_get(&command);
+            break;
+        case e_MON_CMD_CHECKPOINT_SET:
+            binmon_process_checkpoint_set(&command);
+            break;
+        case e_MON_CMD_CHECKPOINT_DELETE:
+            binmon_process_checkpoint_delete(&command);
+            break;
+        case e_MON_CMD_CHECKPOINT_LIST:
+            binmon_process_checkpoint_list(&command);
+            break;
+        case e_MON_CMD_CHECKPOINT_TOGGLE:
+            binmon_process_checkpoint_toggle(&command);
+            break;
+        case e_MON_CMD_REGISTERS_GET:
+            binmon_process_registers_get(&command);
+            break;
+        case e_MON_CMD_REGISTERS_SET:
+            binmon_process_registers_set(&command);
+            break;
+        case e_MON_CMD_ADVANCE_INSTRUCTIONS:
+            binmon_process_advance_instructions(&command);
+            break;
+        case e_MON_CMD_KEYBOARD_FEED:
+            binmon_process_keyboard_feed(&command);
+            break;
+        case e_MON_CMD_BANKS_AVAILABLE:
+            binmon_process_banks_available(&command);
+            break;
+        case e_MON_CMD_REGISTERS_AVAILABLE:
+            binmon_process_registers_available(&command);
+            break;
+        case e_MON_CMD_EXIT:
+            exit_mon = 1;
+            binmon_response(0, e_MON_RESPONSE_EXIT, e_MON_ERR_OK, command.request_id, NULL);
+            break;
+        case e_MON_CMD_RESET:
+            binmon_process_reset(&command);
+            break;
+        default:
+            binmon_error(e_MON_ERR_CMD_INVALID_TYPE, command.request_id);
+            log_message(LOG_DEFAULT, "Binary monitor: unknown command 0x%02x.", command.type);
+            break;
+    }
+}
+
+/* Serve the complete requests in the receive buffer, until one resumes a
+   stopped machine.  */
+static void binmon_process_commands(void)
+{
+    size_t size;
+
+    while (!exit_mon && (size = binmon_command_available()) != 0) {
+        binmon_process_command(rx_buffer);
+        if (size < rx_length) {
+            memmove(rx_buffer, rx_buffer + size, rx_length - size);
+        }
+        rx_length -= size;
+    }
+}
+
+/* Let the stopped machine run again; the held CPUs continue with the
+   instruction they were held at.  */
+static void binmon_resume(void)
+{
+    unsigned char response[2];
+    int mem;
+
+    write_uint16((uint16_t)register_get(binmon_stop_mem, e_PC), response);
+    binmon_response(sizeof response, e_MON_RESPONSE_RESUMED, e_MON_ERR_OK, MON_EVENT_ID, response);
+
+    for (mem = FIRST_SPACE; mem <= LAST_SPACE; mem++) {
+        binmon_resuming[mem] = binmon_held[mem];
+        binmon_held[mem] = 0;
+    }
+    binmon_stopped = 0;
+    exit_mon = 0;
+
+    binmon_update_masks();
+}
+
+/* ------------------------------------------------------------------------- */
+/* Monitor hooks called by the CPU cores.  */
+
+void monitor_init(monitor_interface_t *maincpu_interface_init,
+                  monitor_interface_t *drive_interface_init[],
+                  monitor_cpu_type_t **asmarray)
+{
+    int dnr;
+
+    memset(mon_interfaces, 0, sizeof(mon_interfaces));
+    mon_interfaces[e_comp_space] = maincpu_interface_init;
+    for (dnr = 0; dnr < NUM_DISK_UNITS; dnr++) {
+        mon_interfaces[e_disk8_space + dnr] = drive_interface_init[dnr];
+    }
+    memset(watch_enabled, 0, sizeof(watch_enabled));
+}
+
+void monitor_shutdown(void)
+{
+    monitor_binary_close();
+
+    while (checkpoints) {
+        checkpoint_delete(checkpoints->checknum);
+    }
+    memset(mon_interfaces, 0, sizeof(mon_interfaces));
+}
+
+void monitor_watch_push_load_addr(uint16_t addr, MEMSPACE mem)
+{
+    if (watch_load_count[mem] < WATCH_MAX) {
+        watch_load_array[watch_load_count[mem]++][mem] = addr;
+    }
+}
+
+void monitor_watch_push_store_addr(uint16_t addr, MEMSPACE mem)
+{
+    if (watch_store_count[mem] < WATCH_MAX) {
+        watch_store_array[watch_store_count[mem]++][mem] = addr;
+    }
+}
+
+int monitor_force_import(MEMSPACE mem)
+{
+    binmon_skip[mem] = binmon_resuming[mem];
+    if (!binmon_resuming[mem]) {
+        return 0;
+    }
+
+    binmon_resuming[mem] = 0;
+    if (!monitor_mask[mem]) {
+        binmon_update_masks();
+    }
+
+    return 1;
+}
+
+/* called by cpu core */
+void monitor_check_icount(uint16_t pc)
+{
+    uint8_t opcode;
+
+    if (!instruction_count || binmon_stopped || binmon_skip[step_mem]) {
+        return;
+    }
+
+    if (wait_for_return_level == 0) {
+        instruction_count--;
+    }
+
+    if (skip_jsrs && (step_mem != e_comp_space || traps_checkaddr(pc) == 0)) {
+        opcode = binmon_peek(step_mem, 0, pc, 0);
+        if (opcode == OP_JSR) {
+            wait_for_return_level++;
+        }
+        if (opcode == OP_RTS || opcode == OP_RTI) {
+            wait_for_return_level--;
+        }
+        if (wait_for_return_level < 0) {
+            wait_for_return_level = 0;
+        }
+    }
+
+    if (instruction_count != 0) {
+        return;
+    }
+
+    binmon_update_masks();
+
+    binmon_stop = 1;
+    binmon_stop_mem = step_mem;
+    monitor_startup(step_mem);
+}
+
+/* called by cpu core */
+void monitor_check_icount_interrupt(void)
+{
+    if (instruction_count && skip_jsrs) {
+        wait_for_return_level++;
+    }
+}
+
+int monitor_check_breakpoints(MEMSPACE mem, uint16_t addr)
+{
+    if (binmon_stopped || binmon_skip[mem]) {
+        return 0;
+    }
+
+    if (checkpoints_check(mem, addr, e_exec)) {
+        return 1;
+    }
+
+    return binmon_pending && mem == e_comp_space;
+}
+
+void monitor_check_watchpoints(unsigned int lastpc, unsigned int pc)
+{
+    int mem;
+    unsigned int i;
+
+    for (mem = FIRST_SPACE; mem <= LAST_SPACE; mem++) {
+        for (i = 0; i < watch_load_count[mem]; i++) {
+            checkpoints_check((MEMSPACE)mem, watch_load_array[i][mem], e_load);
+        }
+        for (i = 0; i < watch_store_count[mem]; i++) {
+            checkpoints_check((MEMSPACE)mem, watch_store_array[i][mem], e_store);
+        }
+        watch_load_count[mem] = 0;
+        watch_store_count[mem] = 0;
+
+        if (binmon_stop) {
+            monitor_startup((MEMSPACE)mem);
+        }
+    }
+}
+
+/* Called at an instruction boundary, with the registers of the calling CPU
+   exported to its monitor interface.  */
+void monitor_startup(MEMSPACE mem)
+{
+    unsigned char response[2];
+
+    if (binmon_stopped) {
+        return;
+    }
+
+    binmon_pending = 0;
+    exit_mon = 0;
+
+    if (binmon_stop && connected_fd >= 0) {
+        mem = binmon_stop_mem;
+
+        binmon_response_register_info(MON_EVENT_ID, mem);
+        write_uint16((uint16_t)register_get(mem, e_PC), response);
+        binmon_response(sizeof response, e_MON_RESPONSE_STOPPED, e_MON_ERR_OK, MON_EVENT_ID, response);
+
+        /* The CPU leaves its loop when it returns from here, commands
+           are served from the poll.  */
+        binmon_stopped = 1;
+    } else if (binmon_receive(0) >= 0) {
+        binmon_process_commands();
+    }
+
+    binmon_stop = 0;
+    exit_mon = 0;
+
+    /* Anything left over is served at the next poll.  */
+    binmon_update_masks();
+}
+
+/* Called by a CPU after the monitor checks of an instruction boundary.
+   Returns 1 if the machine is stopped; the CPU then leaves its loop before
+   the instruction.  */
+int monitor_binary_hold(MEMSPACE mem)
+{
+    if (!binmon_stopped) {
+        return 0;
+    }
+
+    binmon_held[mem] = 1;
+
+    return 1;
+}
+
+/* The machine is stopped and the main CPU is held, so the frontend can
+   skip the main loop.  */
+int monitor_binary_stopped(void)
+{
+    return binmon_stopped && binmon_held[e_comp_space];
+}
+
+int monitor_is_binary(void)
+{
+    return connected_fd >= 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Socket handling, driven by the libretro frontend.  */
+
+int monitor_binary_open(const char *path)
+{
+    struct sockaddr_un addr;
+
+    if (socket_path && !strcmp(socket_path, path) && listen_fd >= 0) {
+        return 0;
+    }
+
+    monitor_binary_close();
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        log_error(LOG_DEFAULT, "Binary monitor: socket path '%s' is too long.", path);
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        log_error(LOG_DEFAULT, "Binary monitor: could not create socket.");
+        return -1;
+    }
+
+    unlink(path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || listen(listen_fd, 1) < 0) {
+        log_error(LOG_DEFAULT, "Binary monitor: could not listen on '%s'.", path);
+        close(listen_fd);
+        listen_fd = -1;
+        return -1;
+    }
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    socket_path = lib_strdup(path);
+    log_message(LOG_DEFAULT, "Binary monitor: listening on '%s'.", path);
+
+    return 0;
+}
+
+void monitor_binary_close(void)
+{
+    binmon_disconnect();
+
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        listen_fd = -1;
+    }
+    if (socket_path) {
+        unlink(socket_path);
+        lib_free(socket_path);
+        socket_path = NULL;
+    }
+
+    lib_free(rx_buffer);
+    rx_buffer = NULL;
+    rx_size = 0;
+    lib_free(tx_buffer);
+    tx_buffer = NULL;
+    tx_size = 0;
+
+    instruction_count = 0;
+    binmon_pending = 0;
+    if (mon_interfaces[e_comp_space]) {
+        if (binmon_stopped) {
+            binmon_resume();
+        }
+        binmon_update_masks();
+    }
+}
+
+/* Called once per frame; never blocks.  */
+void monitor_binary_poll(void)
+{
+    struct pollfd pfd;
+
+    if (listen_fd < 0 || !mon_interfaces[e_comp_space]) {
+        return;
+    }
+
+    if (binmon_stopped) {
+        /* Serve the client until it resumes the machine, or let the
+           machine run again when it is gone. The main CPU registers are
+           only valid once it is held.  */
+        binmon_flush();
+        if (!binmon_held[e_comp_space]) {
+            return;
+        }
+        if (binmon_receive(0) >= 0) {
+            binmon_process_commands();
+        }
+        if (exit_mon || connected_fd < 0) {
+            binmon_resume();
+        }
+        return;
+    }
+
+    if (connected_fd < 0) {
+        connected_fd = accept(listen_fd, NULL, NULL);
+        if (connected_fd < 0) {
+            return;
+        }
+        fcntl(connected_fd, F_SETFL, fcntl(connected_fd, F_GETFL, 0) | O_NONBLOCK);
+        log_message(LOG_DEFAULT, "Binary monitor: client connected.");
+    }
+
+    binmon_flush();
+    if (connected_fd < 0) {
+        return;
+    }
+
+    pfd.fd = connected_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    if (rx_length || poll(&pfd, 1, 0) > 0) {
+        binmon_pending = 1;
+        binmon_update_masks();
+    }
+}
+
+#endif /* HAVE_BINARY_MONITOR */
@@ -1,14 +0,0 @@
-int drv_1520_init_resources(void)
-{
-    return 0;
-}
-
-int drv_1520_init(void)
-{
-    return 0;
-}
-
-void drv_1520_shutdown(void)
-{
-}
-
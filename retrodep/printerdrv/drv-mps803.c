@@ -1,13 +0,0 @@
-int drv_mps803_init_resources(void)
-{
-    return 0;
-}
-
-int drv_mps803_init(void)
-{
-    return 0;
-}
-
-void drv_mps803_shutdown(void)
-{
-}
@@ -1,17 +0,0 @@
-int drv_nl10_init_resources(void)
-{
-    return 0;
-}
-
-int drv_nl10_init(void)
-{
-    return 0;
-}
-
-void drv_nl10_shutdown(void)
-{
-}
-
-void drv_nl10_reset(void)
-{
-}
@@ -0,0 +1,656 @@
+/*
+ * output-graphics.c - Output a graphics file (libretro).
+ *
+ * Written by
+ *  Andreas Boose <viceteam@t-online.de>
+ *
+ * This file is part of VICE, the Versatile Commodore Emulator.
+ * See README for copyright notice.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+ *  02111-1307  USA.
+ *
+ */
+
+/*
+ * Unlike the stand-alone version, which hands every finished line to a
+ * gfxoutputdrv, the printed page is kept in memory as palette indices.
+ * A finished page is written as a PNG file in the save directory, on a
+ * worker thread where threads are available.
+ */
+
+#include "vice.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#include "archdep.h"
+#include "lib.h"
+#include "log.h"
+#include "output-select.h"
+#include "output-graphics.h"
+#include "output.h"
+#include "palette.h"
+#include "resources.h"
+#include "types.h"
+#include "util.h"
+
+#define OUTPUT_GFX_COLORS 5
+
+/* Size of the IDAT chunks written */
+#define PNG_CHUNK_SIZE 65536
+
+struct output_gfx_s {
+    uint8_t *page;
+    char *filename;
+    uint8_t colors[OUTPUT_GFX_COLORS][3];
+    unsigned int num_colors;
+    unsigned int width;
+    unsigned int height;
+    unsigned int dpi_x;
+    unsigned int dpi_y;
+    unsigned int page_no;
+    unsigned int isopen;
+    unsigned int line_pos;
+    unsigned int line_no;
+};
+typedef struct output_gfx_s output_gfx_t;
+
+static output_gfx_t output_gfx[NUM_OUTPUT_SELECT];
+
+/* A finished page waiting to be written.  */
+struct output_gfx_page_s {
+    uint8_t *page;
+    char *path;
+    uint8_t colors[OUTPUT_GFX_COLORS][3];
+    unsigned int num_colors;
+    unsigned int width;
+    unsigned int height;
+    unsigned int dpi_x;
+    unsigned int dpi_y;
+    int status;
+    struct output_gfx_page_s *next;
+};
+typedef struct output_gfx_page_s output_gfx_page_t;
+
+/* Result of writing a page, logged when the page is reaped.  */
+enum {
+    PAGE_WRITTEN = 0,
+    PAGE_OPEN_ERROR,
+    PAGE_WRITE_ERROR
+};
+
+#ifdef HAVE_THREADS
+static sthread_t *writer_thread = NULL;
+static slock_t *writer_lock = NULL;
+static scond_t *writer_cond = NULL;
+static output_gfx_page_t *writer_queue = NULL;
+static output_gfx_page_t *writer_done = NULL;
+static int writer_quit = 0;
+#endif
+
+/* Palette index of each output pixel character.  */
+static uint8_t pixel_to_palette_index[256];
+
+static const uint8_t default_colors[OUTPUT_GFX_COLORS][3] = {
+    { 0x00, 0x00, 0x00 },
+    { 0xff, 0xff, 0xff },
+    { 0x00, 0x00, 0xff },
+    { 0x00, 0xff, 0x00 },
+    { 0xff, 0x00, 0x00 }
+};
+
+/* ------------------------------------------------------------------------- */
+
+static void png_write_uint32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+static int png_write_chunk(FILE *fd, const char *type, const uint8_t *data, uint32_t length)
+{
+    uint8_t header[8];
+    uint8_t crc[4];
+    uLong sum;
+
+    png_write_uint32(header, length);
+    memcpy(header + 4, type, 4);
+
+    sum = crc32(0L, Z_NULL, 0);
+    sum = crc32(sum, header + 4, 4);
+    if (length) {
+        sum = crc32(sum, data, length);
+    }
+    png_write_uint32(crc, (uint32_t)sum);
+
+    if (fwrite(header, 1, 8, fd) != 8
+        || (length && fwrite(data, 1, length, fd) != length)
+        || fwrite(crc, 1, 4, fd) != 4) {
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Compress the page into IDAT chunks, one filter byte per row.  */
+static int png_write_image(FILE *fd, const output_gfx_page_t *p)
+{
+    static const uint8_t filter_none = 0;
+    uint8_t *out = lib_malloc(PNG_CHUNK_SIZE);
+    z_stream zs;
+    unsigned int y;
+    int err = 0;
+    int flush;
+
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit(&zs, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        lib_free(out);
+        return -1;
+    }
+
+    zs.next_out = out;
+    zs.avail_out = PNG_CHUNK_SIZE;
+
+    for (y = 0; y <= p->height && !err; y++) {
+        int part;
+
+        /* Row filter byte, then the row; a final empty pass finishes.  */
+        for (part = 0; part < 2 && !err; part++) {
+            if (y == p->height) {
+                zs.next_in = NULL;
+                zs.avail_in = 0;
+                flush = Z_FINISH;
+                part = 1;
+            } else if (part == 0) {
+                zs.next_in = (Bytef *)&filter_none;
+                zs.avail_in = 1;
+                flush = Z_NO_FLUSH;
+            } else {
+                zs.next_in = (Bytef *)(p->page + y * p->width);
+                zs.avail_in = p->width;
+                flush = Z_NO_FLUSH;
+            }
+
+            for (;;) {
+                int ret = deflate(&zs, flush);
+
+                if (ret == Z_STREAM_ERROR) {
+                    err = -1;
+                    break;
+                }
+                if (zs.avail_out == 0 || (flush == Z_FINISH && ret == Z_STREAM_END)) {
+                    if (png_write_chunk(fd, "IDAT", out, PNG_CHUNK_SIZE - zs.avail_out) < 0) {
+                        err = -1;
+                        break;
+                    }
+                    zs.next_out = out;
+                    zs.avail_out = PNG_CHUNK_SIZE;
+                }
+                if (flush == Z_FINISH ? ret == Z_STREAM_END : zs.avail_in == 0) {
+                    break;
+                }
+            }
+        }
+    }
+
+    deflateEnd(&zs);
+    lib_free(out);
+
+    return err;
+}
+
+/* May run on the writer thread, so it only records its result in the
+   page; page_reap logs it from the main thread.  */
+static void png_write_page(output_gfx_page_t *p)
+{
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    uint8_t ihdr[13];
+    uint8_t phys[9];
+    uint8_t plte[OUTPUT_GFX_COLORS * 3];
+    FILE *fd;
+    int err;
+
+    fd = fopen(p->path, MODE_WRITE);
+    if (fd == NULL) {
+        p->status = PAGE_OPEN_ERROR;
+        return;
+    }
+
+    /* 8 bit palette image */
+    png_write_uint32(ihdr, p->width);
+    png_write_uint32(ihdr + 4, p->height);
+    ihdr[8] = 8;
+    ihdr[9] = 3;
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+
+    /* Resolution in pixels per metre */
+    png_write_uint32(phys, (uint32_t)(p->dpi_x * 10000 / 254));
+    png_write_uint32(phys + 4, (uint32_t)(p->dpi_y * 10000 / 254));
+    phys[8] = 1;
+
+    memcpy(plte, p->colors, p->num_colors * 3);
+
+    err = fwrite(signature, 1, sizeof(signature), fd) != sizeof(signature)
+          || png_write_chunk(fd, "IHDR", ihdr, sizeof(ihdr)) < 0
+          || png_write_chunk(fd, "pHYs", phys, sizeof(phys)) < 0
+          || png_write_chunk(fd, "PLTE", plte, p->num_colors * 3) < 0
+          || png_write_image(fd, p) < 0
+          || png_write_chunk(fd, "IEND", NULL, 0) < 0;
+
+    fclose(fd);
+
+    p->status = err ? PAGE_WRITE_ERROR : PAGE_WRITTEN;
+}
+
+/* Log the result of a written page and free it.  */
+static void page_reap(output_gfx_page_t *p)
+{
+    switch (p->status) {
+        case PAGE_OPEN_ERROR:
+            log_error(LOG_DEFAULT, "Cannot write printer page '%s'.", p->path);
+            break;
+        case PAGE_WRITE_ERROR:
+            log_error(LOG_DEFAULT, "Error writing printer page '%s'.", p->path);
+            break;
+        default:
+            log_message(LOG_DEFAULT, "Printer page written to '%s'.", p->path);
+            break;
+    }
+
+    lib_free(p->page);
+    lib_free(p->path);
+    lib_free(p);
+}
+
+/* ------------------------------------------------------------------------- */
+
+#ifdef HAVE_THREADS
+static void writer_thread_func(void *data)
+{
+    slock_lock(writer_lock);
+    for (;;) {
+        output_gfx_page_t *p = writer_queue;
+
+        if (p == NULL) {
+            if (writer_quit) {
+                break;
+            }
+            scond_wait(writer_cond, writer_lock);
+            continue;
+        }
+        writer_queue = p->next;
+        slock_unlock(writer_lock);
+
+        png_write_page(p);
+
+        slock_lock(writer_lock);
+        p->next = writer_done;
+        writer_done = p;
+    }
+    slock_unlock(writer_lock);
+}
+
+/* Reap the pages the writer has finished, oldest first.  */
+static void writer_reap(void)
+{
+    output_gfx_page_t *done, *prev = NULL;
+
+    slock_lock(writer_lock);
+    done = writer_done;
+    writer_done = NULL;
+    slock_unlock(writer_lock);
+
+    while (done != NULL) {
+        output_gfx_page_t *next = done->next;
+
+        done->next = prev;
+        prev = done;
+        done = next;
+    }
+    while (prev != NULL) {
+        output_gfx_page_t *next = prev->next;
+
+        page_reap(prev);
+        prev = next;
+    }
+}
+#endif
+
+static void page_submit(output_gfx_page_t *p)
+{
+#ifdef HAVE_THREADS
+    output_gfx_page_t **tail;
+
+    if (writer_thread == NULL) {
+        writer_lock = slock_new();
+        writer_cond = scond_new();
+        writer_quit = 0;
+        if (writer_lock && writer_cond) {
+            writer_thread = sthread_create(writer_thread_func, NULL);
+        }
+    }
+
+    if (writer_thread != NULL) {
+        writer_reap();
+
+        p->next = NULL;
+        slock_lock(writer_lock);
+        for (tail = &writer_queue; *tail; tail = &(*tail)->next) {
+        }
+        *tail = p;
+        scond_signal(writer_cond);
+        slock_unlock(writer_lock);
+        return;
+    }
+#endif
+
+    png_write_page(p);
+    page_reap(p);
+}
+
+/* Write the pages still queued and stop the writer.  */
+static void writer_shutdown(void)
+{
+#ifdef HAVE_THREADS
+    if (writer_thread != NULL) {
+        slock_lock(writer_lock);
+        writer_quit = 1;
+        scond_signal(writer_cond);
+        slock_unlock(writer_lock);
+
+        sthread_join(writer_thread);
+        writer_thread = NULL;
+
+        writer_reap();
+    }
+    if (writer_cond != NULL) {
+        scond_free(writer_cond);
+        writer_cond = NULL;
+    }
+    if (writer_lock != NULL) {
+        slock_free(writer_lock);
+        writer_lock = NULL;
+    }
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void output_graphics_begin_page(output_gfx_t *o)
+{
+    o->page = lib_malloc(o->width * o->height);
+    memset(o->page, pixel_to_palette_index[OUTPUT_PIXEL_WHITE], o->width * o->height);
+
+    o->isopen = 1;
+    o->line_pos = 0;
+    o->line_no = 0;
+}
+
+/* Hand the page over to the writer; the rest of it stays blank.  */
+static void output_graphics_end_page(output_gfx_t *o)
+{
+    output_gfx_page_t *p = lib_malloc(sizeof(output_gfx_page_t));
+    char number[8];
+
+    o->page_no = (o->page_no + 1) % 100;
+    sprintf(number, "%02u", o->page_no);
+
+    p->page = o->page;
+    p->path = util_concat(SAVEDIR, ARCHDEP_DIR_SEP_STR, o->filename, number, ".png", NULL);
+    memcpy(p->colors, o->colors, sizeof(p->colors));
+    p->num_colors = o->num_colors;
+    p->width = o->width;
+    p->height = o->height;
+    p->dpi_x = o->dpi_x;
+    p->dpi_y = o->dpi_y;
+    p->next = NULL;
+
+    o->page = NULL;
+    o->isopen = 0;
+
+    page_submit(p);
+}
+
+static int output_graphics_open(unsigned int prnr,
+                                output_parameter_t *output_parameter)
+{
+    output_gfx_t *o = &(output_gfx[prnr]);
+    const char *filename;
+    char *ext;
+    palette_t *palette = output_parameter->palette;
+    unsigned int i;
+    int device = 0;
+
+    switch (prnr) {
+        case 0:
+            resources_get_int("Printer4TextDevice", &device);
+            break;
+        case 1:
+            resources_get_int("Printer5TextDevice", &device);
+            break;
+        case 2:
+            resources_get_int("PrinterUserportTextDevice", &device);
+            break;
+    }
+
+    resources_get_string_sprintf("PrinterTextDevice%d", &filename, device + 1);
+
+    if (filename == NULL) {
+        filename = "prngfx";
+    }
+
+    if (o->isopen) {
+        output_graphics_end_page(o);
+    }
+
+    /* Pages are numbered PNG files next to the text output */
+    lib_free(o->filename);
+    o->filename = lib_strdup(filename);
+    ext = strrchr(o->filename, '.');
+    if (ext != NULL && strchr(ext, ARCHDEP_DIR_SEP_CHR) == NULL) {
+        *ext = '\0';
+    }
+
+    o->width = output_parameter->maxcol;
+    o->height = output_parameter->maxrow;
+    o->dpi_x = output_parameter->dpi_x;
+    o->dpi_y = output_parameter->dpi_y;
+
+    /* A palette that failed to load is all black */
+    o->num_colors = OUTPUT_GFX_COLORS;
+    memcpy(o->colors, default_colors, sizeof(o->colors));
+    if (palette != NULL && palette->num_entries > 1
+        && (palette->entries[1].red | palette->entries[1].green | palette->entries[1].blue)) {
+        o->num_colors = palette->num_entries < OUTPUT_GFX_COLORS ? palette->num_entries : OUTPUT_GFX_COLORS;
+        for (i = 0; i < o->num_colors; i++) {
+            o->colors[i][0] = palette->entries[i].red;
+            o->colors[i][1] = palette->entries[i].green;
+            o->colors[i][2] = palette->entries[i].blue;
+        }
+    }
+
+
+    return 0;
+}
+
+static void output_graphics_close(unsigned int prnr)
+{
+    output_gfx_t *o = &(output_gfx[prnr]);
+
+    /* only do this if something has actually been printed on this page */
+    if (o->isopen) {
+        output_graphics_end_page(o);
+    }
+}
+
+static int output_graphics_putc(unsigned int prnr, uint8_t b)
+{
+    output_gfx_t *o = &(output_gfx[prnr]);
+
+    if (!o->isopen) {
+        output_graphics_begin_page(o);
+    }
+
+    if (b == OUTPUT_NEWLINE) {
+        o->line_pos = 0;
+
+        /* check for bottom of page */
+        o->line_no++;
+        if (o->line_no == o->height) {
+            output_graphics_end_page(o);
+        }
+    } else {
+        /* store pixel in page */
+        if (o->line_pos < o->width) {
+            o->page[o->line_no * o->width + o->line_pos] = pixel_to_palette_index[b];
+        }
+        if (o->line_pos < o->width - 1) {
+            o->line_pos++;
+        }
+    }
+
+    return 0;
+}
+
+static int output_graphics_putspan(unsigned int prnr, const uint8_t *pixels, unsigned int count)
+{
+    output_gfx_t *o = &(output_gfx[prnr]);
+    uint8_t *dest;
+    unsigned int i, n;
+
+    if (!count) {
+        return 0;
+    }
+
+    if (!o->isopen) {
+        output_graphics_begin_page(o);
+    }
+
+    /* Pixels past the right edge all land on the last column, as with
+       output_graphics_putc().  */
+    n = o->width - o->line_pos;
+    if (n > count) {
+        n = count;
+    }
+
+    dest = o->page + o->line_no * o->width + o->line_pos;
+    for (i = 0; i < n; i++) {
+        dest[i] = pixel_to_palette_index[pixels[i]];
+    }
+
+    if (n < count) {
+        dest[n - 1] = pixel_to_palette_index[pixels[count - 1]];
+    }
+
+    o->line_pos += n;
+    if (o->line_pos > o->width - 1) {
+        o->line_pos = o->width - 1;
+    }
+
+    return 0;
+}
+
+static int output_graphics_getc(unsigned int prnr, uint8_t *b)
+{
+    return 0;
+}
+
+static int output_graphics_flush(unsigned int prnr)
+{
+    return 0;
+}
+
+static int output_graphics_formfeed(unsigned int prnr)
+{
+    /*
+     * Will finish writing current file, and leaves open
+     * the option to start a new one.
+     */
+    output_graphics_close(prnr);
+
+    return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void output_graphics_init(void)
+{
+    unsigned int i;
+
+    /*
+     * The palette colour order is black, white, blue, green, red.
+     * The black and white printers only have the former two.
+     */
+    memset(pixel_to_palette_index, 1, sizeof(pixel_to_palette_index));
+    pixel_to_palette_index[OUTPUT_PIXEL_BLACK] = 0;
+    pixel_to_palette_index[OUTPUT_PIXEL_BLUE] = 2;
+    pixel_to_palette_index[OUTPUT_PIXEL_GREEN] = 3;
+    pixel_to_palette_index[OUTPUT_PIXEL_RED] = 4;
+
+    for (i = 0; i < NUM_OUTPUT_SELECT; i++) {
+        output_gfx[i].filename = NULL;
+        output_gfx[i].page = NULL;
+        output_gfx[i].page_no = 0;
+        output_gfx[i].isopen = 0;
+        output_gfx[i].line_pos = 0;
+    }
+}
+
+void output_graphics_shutdown(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < NUM_OUTPUT_SELECT; i++) {
+        output_graphics_close(i);
+
+        lib_free(output_gfx[i].filename);
+        lib_free(output_gfx[i].page);
+
+        output_gfx[i].filename = NULL;
+        output_gfx[i].page = NULL;
+    }
+
+    writer_shutdown();
+}
+
+int output_graphics_init_resources(void)
+{
+    output_select_t output_select;
+
+    output_select.output_name = "graphics";
+    output_select.output_open = output_graphics_open;
+    output_select.output_close = output_graphics_close;
+    output_select.output_putc = output_graphics_putc;
+    output_select.output_getc = output_graphics_getc;
+    output_select.output_flush = output_graphics_flush;
+    output_select.output_formfeed = output_graphics_formfeed;
+    output_select.output_putspan = output_graphics_putspan;
+
+    output_select_register(&output_select);
+
+    return 1;
+}
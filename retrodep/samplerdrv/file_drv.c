@@ -1,7 +0,0 @@
-void fileaudio_init(void)
-{
-}
-
-void fileaudio_shutdown(void)
-{
-}
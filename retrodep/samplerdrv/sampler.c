@@ -1,31 +0,0 @@
-int sampler_resources_init(void)
-{
-    return 0;
-}
-
-void sampler_resources_shutdown(void)
-{
-}
-
-int sampler_cmdline_options_init(void)
-{
-    return 0;
-}
-
-
-void sampler_reset(void)
-{
-}
-
-void sampler_start(int channels, char *devname)
-{
-}
-
-void sampler_stop(void)
-{
-}
-
-int sampler_get_sample(int channel)
-{
-    return 0;
-}
@@ -53,6 +53,7 @@ static char *current_module = NULL;
 static char read_name[SNAPSHOT_MACHINE_NAME_LEN];
 static char *current_machine_name = NULL;
 static char *current_filename = NULL;
+static char memory_filename[] = "<memory>";
 
 char snapshot_magic_string[] = "VICE Snapshot File\032";
 char snapshot_version_magic_string[] = "VICE Version\032";
@@ -87,6 +88,9 @@ struct snapshot_stream_ops_s {
 
     /* Get filename or counterpart for logging */
     const char* (*filename)(snapshot_stream_t* stream);
+
+    /* Overwrite already written data without moving the stream pointer */
+    int         (*patch)(snapshot_stream_t* stream, long offset, const void* ptr, size_t size);
 };
 
 /* Stream base */
@@ -156,6 +160,90 @@ struct snapshot_s {
     int write_mode;
 };
 
+/* ------------------------------------------------------------------------- */
+/* Per-operation arena */
+
+/* Everything that lives only for the duration of one snapshot operation
+   (stream, snapshot and module headers, temporary module buffers) is
+   carved out of a single bump arena.  The arena is reset when a new stream
+   is opened, and grows to the previous high-water mark at that point, so
+   steady state (e.g. run-ahead serializing every frame) does no heap
+   traffic at all.  */
+
+#define SNAPSHOT_ARENA_ALIGN    16
+#define SNAPSHOT_ARENA_MIN_SIZE 0x1000
+
+typedef struct snapshot_arena_overflow_s {
+    struct snapshot_arena_overflow_s *next;
+} snapshot_arena_overflow_t;
+
+static struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    size_t high_water;
+    snapshot_arena_overflow_t *overflow;
+} snapshot_arena = { NULL, 0, 0, 0, NULL };
+
+static void snapshot_arena_reset(void)
+{
+    while (snapshot_arena.overflow != NULL) {
+        snapshot_arena_overflow_t *next = snapshot_arena.overflow->next;
+        lib_free(snapshot_arena.overflow);
+        snapshot_arena.overflow = next;
+    }
+
+    if (snapshot_arena.high_water > snapshot_arena.size) {
+        size_t size = SNAPSHOT_ARENA_MIN_SIZE;
+
+        while (size < snapshot_arena.high_water) {
+            size <<= 1;
+        }
+        lib_free(snapshot_arena.base);
+        snapshot_arena.base = lib_malloc(size);
+        snapshot_arena.size = size;
+    }
+
+    snapshot_arena.used = 0;
+    snapshot_arena.high_water = 0;
+}
+
+void *snapshot_temp_alloc(size_t size)
+{
+    snapshot_arena_overflow_t *block;
+    size_t used;
+
+    size = (size + SNAPSHOT_ARENA_ALIGN - 1) & ~(size_t)(SNAPSHOT_ARENA_ALIGN - 1);
+    used = snapshot_arena.used + size;
+    snapshot_arena.high_water += size;
+
+    if (used <= snapshot_arena.size) {
+        void *p = snapshot_arena.base + snapshot_arena.used;
+        snapshot_arena.used = used;
+        return p;
+    }
+
+    /* Out of arena space: fall back to the heap for this operation only,
+       the arena is enlarged on the next reset.  */
+    block = lib_malloc(SNAPSHOT_ARENA_ALIGN + size);
+    block->next = snapshot_arena.overflow;
+    snapshot_arena.overflow = block;
+    return (uint8_t *)block + SNAPSHOT_ARENA_ALIGN;
+}
+
+void snapshot_temp_free(void *ptr)
+{
+    /* Released in bulk when the arena is reset.  */
+}
+
+static void snapshot_set_current_filename(const char *filename)
+{
+    if (current_filename != memory_filename) {
+        lib_free(current_filename);
+    }
+    current_filename = (filename == NULL) ? memory_filename : lib_strdup(filename);
+}
+
 /* ------------------------------------------------------------------------- */
 /* FILE based stream */
 
@@ -208,6 +296,19 @@ static const char* snapshot_file_filename(snapshot_stream_t *f)
     return file_stream->filename;
 }
 
+static int snapshot_file_patch(snapshot_stream_t *f, long offset, const void* ptr, size_t size)
+{
+    snapshot_file_stream_t* file_stream = container_of(f, snapshot_file_stream_t, istream);
+    long pointer = ftell(file_stream->file);
+
+    if (pointer < 0
+        || fseek(file_stream->file, offset, SEEK_SET) < 0
+        || fwrite(ptr, size, 1, file_stream->file) != 1) {
+        return -1;
+    }
+    return fseek(file_stream->file, pointer, SEEK_SET);
+}
+
 static int snapshot_zfile_fclose(snapshot_stream_t *f)
 {
     snapshot_file_stream_t* file_stream = container_of(f, snapshot_file_stream_t, istream);
@@ -234,15 +335,16 @@ static struct snapshot_stream_ops_s snapshot_file_ops = {
     /* seek */ snapshot_file_fseek,
     /* close */ snapshot_file_fclose,
     /* close_erase */ snapshot_file_fclose_erase,
-    /* filename */ snapshot_file_filename
+    /* filename */ snapshot_file_filename,
+    /* patch */ snapshot_file_patch
 };
 
 snapshot_stream_t* snapshot_file_fopen(const char* pathname, const char* mode)
 {
     snapshot_file_stream_t* stream = lib_malloc(sizeof(snapshot_file_stream_t));
 
-    lib_free(current_filename);
-    current_filename = lib_strdup(pathname);
+    snapshot_arena_reset();
+    snapshot_set_current_filename(pathname);
 
     if (stream == NULL) {
         goto fail;
@@ -281,15 +383,16 @@ static struct snapshot_stream_ops_s snapshot_zfile_ops = {
     /* seek */ snapshot_file_fseek,
     /* close */ snapshot_zfile_fclose,
     /* close_erase */ snapshot_zfile_fclose_erase,
-    /* filename */ snapshot_file_filename
+    /* filename */ snapshot_file_filename,
+    /* patch */ snapshot_file_patch
 };
 
 snapshot_stream_t* snapshot_zfile_fopen(const char* pathname, const char* mode)
 {
     snapshot_file_stream_t* stream = lib_malloc(sizeof(snapshot_file_stream_t));
 
-    lib_free(current_filename);
-    current_filename = lib_strdup(pathname);
+    snapshot_arena_reset();
+    snapshot_set_current_filename(pathname);
 
     if (stream == NULL) {
         goto fail;
@@ -391,13 +494,27 @@ static int snapshot_memory_fseek(snapshot_stream_t *f, long offset, int whence)
 static int snapshot_memory_fclose(snapshot_stream_t *f)
 {
     snapshot_memory_stream_t* stream = container_of(f, snapshot_memory_stream_t, istream);
-    lib_free(stream);
+    snapshot_temp_free(stream);
     return 0;
 }
 
 static const char* snapshot_memory_filename(snapshot_stream_t* f)
 {
-    return "<memory>";
+    return memory_filename;
+}
+
+static int snapshot_memory_patch(snapshot_stream_t *f, long offset, const void* ptr, size_t size)
+{
+    snapshot_memory_stream_t* stream = container_of(f, snapshot_memory_stream_t, istream);
+    if (stream->write_mode == 0 || offset < 0 || offset + size > stream->stream_size) {
+        return -1;
+    }
+
+    /* Size query pass: nothing to patch */
+    if (stream->buffer != NULL) {
+        memcpy(stream->buffer + offset, ptr, size);
+    }
+    return 0;
 }
 
 static struct snapshot_stream_ops_s snapshot_memory_ops = {
@@ -407,15 +524,17 @@ static struct snapshot_stream_ops_s snapshot_memory_ops = {
     /* seek */ snapshot_memory_fseek,
     /* close */ snapshot_memory_fclose,
     /* close_erase */ snapshot_memory_fclose,
-    /* filename */ snapshot_memory_filename
+    /* filename */ snapshot_memory_filename,
+    /* patch */ snapshot_memory_patch
 };
 
 snapshot_stream_t* snapshot_memory_write_fopen(void* buffer, size_t buffer_size)
 {
-    snapshot_memory_stream_t* stream = lib_malloc(sizeof(snapshot_memory_stream_t));
+    snapshot_memory_stream_t* stream;
 
-    lib_free(current_filename);
-    current_filename = lib_strdup("<memory>");
+    snapshot_arena_reset();
+    snapshot_set_current_filename(NULL);
+    stream = snapshot_temp_alloc(sizeof(snapshot_memory_stream_t));
 
     if (stream == NULL) {
         goto fail;
@@ -435,7 +554,11 @@ fail:
 
 snapshot_stream_t* snapshot_memory_read_fopen(const void* buffer, size_t buffer_size)
 {
-    snapshot_memory_stream_t* stream = lib_malloc(sizeof(snapshot_memory_stream_t));
+    snapshot_memory_stream_t* stream;
+
+    snapshot_arena_reset();
+    snapshot_set_current_filename(NULL);
+    stream = snapshot_temp_alloc(sizeof(snapshot_memory_stream_t));
     if (stream == NULL) {
         goto fail;
     }
@@ -494,6 +617,17 @@ static const char* snapshot_filename(snapshot_stream_t *f)
     return f->ops->filename(f);
 }
 
+static int snapshot_patch_dword(snapshot_stream_t *f, long offset, uint32_t data)
+{
+    uint8_t buf[4];
+
+    buf[0] = (uint8_t)(data & 0xff);
+    buf[1] = (uint8_t)((data >> 8) & 0xff);
+    buf[2] = (uint8_t)((data >> 16) & 0xff);
+    buf[3] = (uint8_t)(data >> 24);
+    return f->ops->patch(f, offset, buf, sizeof(buf));
+}
+
 /* ------------------------------------------------------------------------- */
 
 static int snapshot_write_byte(snapshot_stream_t *f, uint8_t data)
@@ -759,7 +893,7 @@ static int snapshot_read_string(snapshot_stream_t *f, char **s)
 
 int snapshot_free(snapshot_t *s)
 {
-    lib_free(s);
+    snapshot_temp_free(s);
     return 0;
 }
 
@@ -1056,12 +1190,12 @@ snapshot_module_t *snapshot_module_create(snapshot_t *s, const char *name, uint8
 
     current_module = (char *)name;
 
-    m = lib_malloc(sizeof(snapshot_module_t));
+    m = snapshot_temp_alloc(sizeof(snapshot_module_t));
     m->file = s->file;
     m->offset = snapshot_ftell(s->file);
     if (m->offset == -1) {
         snapshot_error = SNAPSHOT_ILLEGAL_OFFSET_ERROR;
-        lib_free(m);
+        snapshot_temp_free(m);
         return NULL;
     }
     m->write_mode = 1;
@@ -1092,7 +1226,7 @@ snapshot_module_t *snapshot_module_open(snapshot_t *s, const char *name, uint8_t
         return NULL;
     }
 
-    m = lib_malloc(sizeof(snapshot_module_t));
+    m = snapshot_temp_alloc(sizeof(snapshot_module_t));
     m->file = s->file;
     m->write_mode = 0;
 
@@ -1129,16 +1263,15 @@ snapshot_module_t *snapshot_module_open(snapshot_t *s, const char *name, uint8_t
 
 fail:
     snapshot_fseek(s->file, s->first_module_offset, SEEK_SET);
-    lib_free(m);
+    snapshot_temp_free(m);
     return NULL;
 }
 
 int snapshot_module_close(snapshot_module_t *m)
 {
-    /* Backpatch module size if writing.  */
+    /* Backpatch module size in place if writing.  */
     if (m->write_mode
-        && (snapshot_fseek(m->file, m->size_offset, SEEK_SET) < 0
-            || snapshot_write_dword(m->file, m->size) < 0)) {
+        && snapshot_patch_dword(m->file, m->size_offset, m->size) < 0) {
         snapshot_error = SNAPSHOT_MODULE_CLOSE_ERROR;
         return -1;
     }
@@ -1149,7 +1282,7 @@ int snapshot_module_close(snapshot_module_t *m)
         return -1;
     }
 
-    lib_free(m);
+    snapshot_temp_free(m);
     return 0;
 }
 
@@ -1203,7 +1336,7 @@ snapshot_t *snapshot_create_from_stream(snapshot_stream_t *f, uint8_t major_vers
         goto fail;
     }
 
-    s = lib_malloc(sizeof(snapshot_t));
+    s = snapshot_temp_alloc(sizeof(snapshot_t));
     s->file = f;
     s->first_module_offset = snapshot_ftell(f);
     s->write_mode = 1;
@@ -1294,7 +1427,7 @@ snapshot_t *snapshot_open_from_stream(snapshot_stream_t *f, uint8_t *major_versi
         }
     }
 
-    s = lib_malloc(sizeof(snapshot_t));
+    s = snapshot_temp_alloc(sizeof(snapshot_t));
     s->file = f;
     s->first_module_offset = snapshot_ftell(f);
     s->write_mode = 0;
@@ -1340,7 +1473,7 @@ int snapshot_close(snapshot_t *s)
         }
     }
 
-    lib_free(s);
+    snapshot_temp_free(s);
     return retval;
 }
 
@@ -1623,6 +1756,8 @@ int c64_snapshot_read_from_stream(snapshot_stream_t *stream, int event_mode)
 
     joyport_clear_devices();
 
+    sound_snapshot_prepare();
+
     if (maincpu_snapshot_read_module(s) < 0
         || c64_snapshot_read_module(s) < 0
         || ciacore_snapshot_read_module(machine_context.cia1, s) < 0
@@ -1735,6 +1870,8 @@ int c64dtv_snapshot_read_from_stream(snapshot_stream_t *stream, int event_mode)
 
     joyport_clear_devices();
 
+    sound_snapshot_prepare();
+
     if (maincpu_snapshot_read_module(s) < 0
         || c64dtv_snapshot_read_module(s) < 0
         || c64dtvdma_snapshot_read_module(s) < 0
@@ -1840,6 +1977,8 @@ int c128_snapshot_read_from_stream(snapshot_stream_t *stream, int event_mode)
 
     joyport_clear_devices();
 
+    sound_snapshot_prepare();
+
     if (maincpu_snapshot_read_module(s) < 0
         || c128_snapshot_read_module(s) < 0
         || ciacore_snapshot_read_module(machine_context.cia1, s) < 0
@@ -1942,6 +2081,8 @@ int cbm2_snapshot_read_from_stream(snapshot_stream_t *stream, int event_mode)
         goto fail;
     }
 
+    sound_snapshot_prepare();
+
     if (maincpu_snapshot_read_module(s) < 0
         || cbm2_snapshot_read_module(s) < 0
         || crtc_snapshot_read_module(s) < 0
@@ -2050,6 +2191,8 @@ int cbm2_snapshot_read_from_stream(snapshot_stream_t *stream, int event_mode)
 
     joyport_clear_devices();
 
+    sound_snapshot_prepare();
+
     if (maincpu_snapshot_read_module(s) < 0
         || cbm2_snapshot_read_module(s) < 0
         || ciacore_snapshot_read_module(machine_context.cia1, s) < 0
@@ -2160,6 +2303,8 @@ int pet_snapshot_read_from_stream(snapshot_stream_t *stream, int event_mode)
         ef = -1;
     }
 
+    sound_snapshot_prepare();
+
     if (ef
         || maincpu_snapshot_read_module(s) < 0
         || cpu6809_snapshot_read_module(s) < 0
@@ -2265,6 +2410,8 @@ int plus4_snapshot_read_from_stream(snapshot_stream_t *stream, int event_mode)
 
     joyport_clear_devices();
 
+    sound_snapshot_prepare();
+
     if (maincpu_snapshot_read_module(s) < 0
         || plus4_snapshot_read_module(s) < 0
         || drive_snapshot_read_module(s) < 0
@@ -2368,6 +2515,8 @@ int scpu64_snapshot_read_from_stream(snapshot_stream_t *stream, int event_mode)
 
     joyport_clear_devices();
 
+    sound_snapshot_prepare();
+
     if (maincpu_snapshot_read_module(s) < 0
         || scpu64_snapshot_read_module(s) < 0
         || ciacore_snapshot_read_module(machine_context.cia1, s) < 0
@@ -2480,6 +2629,8 @@ int vic20_snapshot_read_from_stream(snapshot_stream_t *stream, int event_mode)
 
     joyport_clear_devices();
 
+    sound_snapshot_prepare();
+
     /* FIXME: Missing sound.  */
     if (maincpu_snapshot_read_module(s) < 0
         || vic20_snapshot_read_module(s) < 0
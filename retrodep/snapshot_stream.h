@@ -184,4 +184,8 @@ extern long snapshot_ftell(snapshot_stream_t *f);
 extern int snapshot_fclose(snapshot_stream_t *f);
 extern int snapshot_fclose_erase(snapshot_stream_t *f);
 
+/* Scratch memory valid until the next snapshot stream is opened */
+extern void *snapshot_temp_alloc(size_t size);
+extern void snapshot_temp_free(void *ptr);
+
 #endif
@@ -75,6 +75,7 @@ extern unsigned int opt_supercpu_kernal;
 
 extern dc_storage* dc;
 extern bool retro_ui_finalized;
+extern int retro_printer_driver;
 extern unsigned int opt_jiffydos;
 extern unsigned int opt_autoloadwarp;
 extern char full_path[RETRO_PATH_MAX];
@@ -447,6 +448,7 @@ int ui_init_finalize(void)
    /* Media */
    log_resources_set_int("AutostartWarp", vice_opt.AutostartWarp);
    log_resources_set_int("VirtualDevice4", vice_opt.VirtualDevices);
+   log_resources_set_int("VirtualDevice6", vice_opt.VirtualDevices);
    log_resources_set_int("VirtualDevice8", !vice_opt.DriveTrueEmulation);
    log_resources_set_int("VirtualDevice9", !vice_opt.DriveTrueEmulation);
    log_resources_set_int("Drive8TrueEmulation", vice_opt.DriveTrueEmulation);
@@ -565,7 +567,32 @@ int ui_init_finalize(void)
 #endif
 
    /* Printer */
-   log_resources_set_int("Printer4", vice_opt.Printer);
+   switch (vice_opt.Printer)
+   {
+      case PRINTER_DRIVER_MPS803:
+      case PRINTER_DRIVER_NL10:
+         log_resources_set_int("Printer4", 1);
+         log_resources_set_string("Printer4Driver", (vice_opt.Printer == PRINTER_DRIVER_MPS803) ? "mps803" : "nl10");
+         log_resources_set_string("Printer4Output", "graphics");
+         break;
+      case PRINTER_DRIVER_1520:
+         log_resources_set_int("Printer4", 0);
+         log_resources_set_int("Printer6", 1);
+         log_resources_set_string("Printer6Output", "graphics");
+         break;
+      default:
+         log_resources_set_int("Printer4", (vice_opt.Printer == PRINTER_DRIVER_ASCII) ? 1 : 0);
+         break;
+   }
+   retro_printer_driver = vice_opt.Printer;
+
+   /* Sampler */
+   if (vice_opt.Sampler)
+   {
+      char tmp_str[RETRO_PATH_MAX] = {0};
+      snprintf(tmp_str, sizeof(tmp_str), "%s%c%s", retro_system_data_directory, ARCHDEP_DIR_SEP_CHR, "sampler.wav");
+      log_resources_set_string("SampleName", tmp_str);
+   }
 
    retro_ui_finalized = true;
    log_resource_set = true;
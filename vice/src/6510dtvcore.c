@@ -1685,6 +1685,9 @@ static const uint8_t fetch_tab[] = {
         pending_interrupt = CPU_INT_STATUS->global_pending_int;
         if (pending_interrupt != IK_NONE) {
             DO_INTERRUPT(pending_interrupt);
+#ifdef LEAVE_IF_MONITOR_STOPPED
+            LEAVE_IF_MONITOR_STOPPED
+#endif
             if (!(CPU_INT_STATUS->global_pending_int & IK_IRQ)
                 && CPU_INT_STATUS->global_pending_int & IK_IRQPEND) {
                 CPU_INT_STATUS->global_pending_int &= ~IK_IRQPEND;
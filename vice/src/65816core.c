@@ -38,6 +38,7 @@
  * - define reg_dbr (Data Bank Register) as 8bit.
  * - define reg_dpr (Direct Page Register) as 16bit.
  * - define reg_emul (65C02 Emulation) as int.
+ * - define reg_width (cached M/X register width, see LOCAL_UPDATE_WIDTH) as 8bit.
  * - define reg_sp as 16bit (8bit on 6502/65C02).
  * - define reg_p as 8bit.
  * - define reg_pc as 16bit.
@@ -166,6 +167,7 @@
         } else {               \
             reg_p &= ~P_BREAK; \
         }                      \
+        LOCAL_UPDATE_WIDTH();  \
     } while (0)
 
 #define LOCAL_SET_DECIMAL(val)   \
@@ -202,6 +204,7 @@
         } else {                 \
             reg_p &= ~P_65816_M; \
         }                        \
+        LOCAL_UPDATE_WIDTH();    \
     } while (0)
 
 #define LOCAL_SET_65816_X(val)   \
@@ -211,13 +214,15 @@
         } else {                 \
             reg_p &= ~P_65816_X; \
         }                        \
+        LOCAL_UPDATE_WIDTH();    \
     } while (0)
 
 #define LOCAL_SET_SIGN(val)      (flag_n = (val) ? 0x80 : 0)
 #define LOCAL_SET_ZERO(val)      (flag_z = !(val))
 #define LOCAL_SET_STATUS(val)    (reg_p = ((val) & ~(P_ZERO | P_SIGN)), \
                                   LOCAL_SET_ZERO((val) & P_ZERO),       \
-                                  flag_n = (val))
+                                  flag_n = (val),                       \
+                                  LOCAL_UPDATE_WIDTH())
 
 #define LOCAL_OVERFLOW()         (reg_p & P_OVERFLOW)
 #define LOCAL_BREAK()            (reg_p & P_BREAK)
@@ -229,8 +234,14 @@
 #define LOCAL_STATUS()           (reg_p | (flag_n & 0x80) | P_UNUSED    \
                                   | (LOCAL_ZERO() ? P_ZERO : 0))
 
-#define LOCAL_65816_M()          (reg_emul || (reg_p & P_65816_M))
-#define LOCAL_65816_X()          (reg_emul || (reg_p & P_65816_X))
+/* The effective accumulator and index register widths only change with
+   reg_emul or the M/X bits of reg_p, so they are cached in reg_width and
+   the opcodes test a single bit. Set bits mean 8 bit registers. */
+#define LOCAL_UPDATE_WIDTH()     (reg_width = reg_emul ? (P_65816_M | P_65816_X) \
+                                                       : (reg_p & (P_65816_M | P_65816_X)))
+
+#define LOCAL_65816_M()          (reg_width & P_65816_M)
+#define LOCAL_65816_X()          (reg_width & P_65816_X)
 
 #define LOCAL_65816_STATUS()     (reg_p | (flag_n & 0x80) | (LOCAL_ZERO() ? P_ZERO : 0))
 
@@ -302,6 +313,7 @@
       reg_p = GLOBAL_REGS.p;                             \
       flag_n = GLOBAL_REGS.n;                            \
       flag_z = GLOBAL_REGS.z;                            \
+      LOCAL_UPDATE_WIDTH();                              \
       if (reg_emul) { /* fixup emulation mode */         \
           reg_x &= 0xff;                                 \
           reg_y &= 0xff;                                 \
@@ -2192,6 +2204,7 @@
       FETCH_PARAM_DUMMY(reg_pc);                         \
       LOCAL_SET_BREAK(0);                                \
       reg_emul = 1;                                      \
+      LOCAL_UPDATE_WIDTH();                              \
       reg_x &= 0xff;                                     \
       reg_y &= 0xff;                                     \
       reg_sp = 0x100 | (reg_sp & 0xff);                  \
@@ -2529,6 +2542,7 @@
       if (LOCAL_CARRY() != reg_emul) {          \
           if (LOCAL_CARRY()) {                  \
               reg_emul = 1;                     \
+              LOCAL_UPDATE_WIDTH();             \
               LOCAL_SET_CARRY(0);               \
               LOCAL_SET_BREAK(0);               \
               reg_x &= 0xff;                    \
@@ -2577,6 +2591,9 @@
 
         if (interrupt65816 != IK_NONE) {
             DO_INTERRUPT(interrupt65816);
+#ifdef LEAVE_IF_MONITOR_STOPPED
+            LEAVE_IF_MONITOR_STOPPED
+#endif
             if (interrupt65816 & IK_RESET) {
                 p0 = 0x102;
             } else if (interrupt65816 & IK_NMI) {
@@ -238,40 +238,94 @@ static void matrix_activate_column(int column, uint8_t *activerows, uint8_t *act
     }
 }
 
+/* the solved matrix only changes when a key changes, so it is cached per
+   line, and for every possible port value (index is the port value, lines
+   that are low are active) as the union of the lines driven low. */
+static struct {
+    int valid;
+    unsigned int serial;    /* keyarr_serial the cache was built for */
+
+    uint8_t rows_by_row[8];
+    uint8_t columns_by_row[8];
+    uint8_t rows_by_column[8];
+    uint8_t columns_by_column[8];
+
+    uint8_t rows_by_rows[256];
+    uint8_t columns_by_rows[256];
+    uint8_t rows_by_columns[256];
+    uint8_t columns_by_columns[256];
+} matrix_cache;
+
+static void matrix_build_port_table(uint8_t *table, const uint8_t *lines)
+{
+    int msk, i;
+
+    table[0xff] = 0;
+    for (msk = 0xfe; msk >= 0; msk--) {
+        /* lowest active line, the rest is already in the table */
+        for (i = 0; msk & (1 << i); i++) {
+        }
+        table[msk] = table[msk | (1 << i)] | lines[i];
+    }
+}
+
+static void matrix_cache_build(void)
+{
+    uint8_t activerows, activecolumns;
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        activerows = 0;
+        activecolumns = 0;
+        matrix_activate_row(i, &activerows, &activecolumns);
+        matrix_cache.rows_by_row[i] = activerows;
+        matrix_cache.columns_by_row[i] = activecolumns;
+
+        activerows = 0;
+        activecolumns = 0;
+        matrix_activate_column(i, &activerows, &activecolumns);
+        matrix_cache.rows_by_column[i] = activerows;
+        matrix_cache.columns_by_column[i] = activecolumns;
+    }
+
+    matrix_build_port_table(matrix_cache.rows_by_rows, matrix_cache.rows_by_row);
+    matrix_build_port_table(matrix_cache.columns_by_rows, matrix_cache.columns_by_row);
+    matrix_build_port_table(matrix_cache.rows_by_columns, matrix_cache.rows_by_column);
+    matrix_build_port_table(matrix_cache.columns_by_columns, matrix_cache.columns_by_column);
+
+    matrix_cache.serial = keyarr_serial;
+    matrix_cache.valid = 1;
+}
+
+inline static void matrix_cache_update(void)
+{
+    if (!matrix_cache.valid || matrix_cache.serial != keyarr_serial) {
+        matrix_cache_build();
+    }
+}
+
 /* get all connected rows for one active column */
 inline static uint8_t matrix_get_active_rows_by_column(int column)
 {
-    uint8_t activerows = 0;
-    uint8_t activecolumns = 0;
-    matrix_activate_column(column, &activerows, &activecolumns);
-    return activerows;
+    return matrix_cache.rows_by_column[column];
 }
 
 /* get all connected rows for one active row */
 inline static uint8_t matrix_get_active_rows_by_row(int row)
 {
-    uint8_t activerows = 0;
-    uint8_t activecolumns = 0;
-    matrix_activate_row(row, &activerows, &activecolumns);
-    return activerows;
+    return matrix_cache.rows_by_row[row];
 }
 
 /* get all connected columns for one active row */
 inline static uint8_t matrix_get_active_columns_by_column(int column)
 {
-    uint8_t activerows = 0;
-    uint8_t activecolumns = 0;
-    matrix_activate_column(column, &activerows, &activecolumns);
-    return activecolumns;
+    return matrix_cache.columns_by_column[column];
 }
 
 /* get all connected columns for one active row */
 inline static uint8_t matrix_get_active_columns_by_row(int row)
 {
-    uint8_t activerows = 0;
-    uint8_t activecolumns = 0;
-    matrix_activate_row(row, &activerows, &activecolumns);
-    return activecolumns;
+    return matrix_cache.columns_by_row[row];
 }
 
 /*
@@ -300,37 +354,39 @@ static uint8_t read_ciapa(cia_context_t *cia_context)
      */
     msk = cia_context->old_pb & read_joyport_dig(JOYPORT_1);
     if (c64keyboard_active) {
-        for (m = 0x1, i = 0; i < 8; m <<= 1, i++) {
-            if (!(msk & m)) {
-                tmp = matrix_get_active_columns_by_column(i);
-
-                /* when scanning from port B to port A with inactive bits set to 1
-                   in port B, ghostkeys will be eliminated (pulled high) if the
-                   matrix is connected to more 1 bits of port B. this does NOT happen
-                   when the respective bits are set to input. (see testprogs/CIA/ciaports)
-                 */
-                if (tmp & cia_context->c_cia[CIA_PRB] & cia_context->c_cia[CIA_DDRB]) {
-                    val &= ~rev_keyarr[i];
-                    DBGA(("<force high %02x>", m));
-                } else {
-                    val &= ~matrix_get_active_rows_by_column(i);
+        matrix_cache_update();
+        if (!(matrix_cache.columns_by_columns[msk]
+              & cia_context->c_cia[CIA_PRB] & cia_context->c_cia[CIA_DDRB])) {
+            /* no active column connected to an output high, use the table */
+            val &= ~matrix_cache.rows_by_columns[msk];
+        } else {
+            for (m = 0x1, i = 0; i < 8; m <<= 1, i++) {
+                if (!(msk & m)) {
+                    tmp = matrix_get_active_columns_by_column(i);
+
+                    /* when scanning from port B to port A with inactive bits set to 1
+                       in port B, ghostkeys will be eliminated (pulled high) if the
+                       matrix is connected to more 1 bits of port B. this does NOT happen
+                       when the respective bits are set to input. (see testprogs/CIA/ciaports)
+                     */
+                    if (tmp & cia_context->c_cia[CIA_PRB] & cia_context->c_cia[CIA_DDRB]) {
+                        val &= ~rev_keyarr[i];
+                        DBGA(("<force high %02x>", m));
+                    } else {
+                        val &= ~matrix_get_active_rows_by_column(i);
+                    }
                 }
             }
         }
     }
     DBGA((" val:%02x", val));
 
-    /* loop over rows,
-       pull down all bits connected to a row which is output and active.
+    /* pull down all bits connected to a row which is output and active.
        handles the case when port a is used for both input and output
      */
     msk = cia_context->old_pa & read_joyport_dig(JOYPORT_2);
     if (c64keyboard_active) {
-        for (m = 0x1, i = 0; i < 8; m <<= 1, i++) {
-            if (!(msk & m)) {
-                val &= ~matrix_get_active_rows_by_row(i);
-            }
-        }
+        val &= ~matrix_cache.rows_by_rows[msk];
     }
     DBGA((" val:%02x", val));
 
@@ -382,25 +438,31 @@ static uint8_t read_ciapb(cia_context_t *cia_context)
 
     msk = cia_context->old_pa & read_joyport_dig(JOYPORT_2);
     if (c64keyboard_active) {
-        for (m = 0x1, i = 0; i < 8; m <<= 1, i++) {
-            if (!(msk & m)) {
-                tmp = matrix_get_active_columns_by_row(i);
-                val &= ~tmp;
-
-                /*
-                    Handle the special case when both port A and port B are programmed as output,
-                    port A outputs (active) low, and port B outputs high.
-
-                    In this case either connecting one port A 0 bit (by pressing either shift-lock)
-                    or two or more port A 0 bits (by pressing keys of the same column) to one port B
-                    bit is required to drive port B low (see testprogs/CIA/ciaports)
-                */
-                if ((cia_context->c_cia[CIA_DDRA] & ~cia_context->c_cia[CIA_PRA] & m) &&
-                    (cia_context->c_cia[CIA_DDRB] & cia_context->c_cia[CIA_PRB] & tmp)) {
-                    DBGB(("(%d)", i));
-                    if (ciapb_forcelow(i, (uint8_t)(cia_context->c_cia[CIA_DDRA] & ~cia_context->c_cia[CIA_PRA]))) {
-                        val_outhi &= ~tmp;
-                        DBGB(("<force low, val_outhi:%02x>", val_outhi));
+        matrix_cache_update();
+        tmp = matrix_cache.columns_by_rows[msk];
+        val &= ~tmp;
+
+        /*
+            Handle the special case when both port A and port B are programmed as output,
+            port A outputs (active) low, and port B outputs high.
+
+            In this case either connecting one port A 0 bit (by pressing either shift-lock)
+            or two or more port A 0 bits (by pressing keys of the same column) to one port B
+            bit is required to drive port B low (see testprogs/CIA/ciaports)
+        */
+        if ((cia_context->c_cia[CIA_DDRA] & ~cia_context->c_cia[CIA_PRA] & ~msk) &&
+            (cia_context->c_cia[CIA_DDRB] & cia_context->c_cia[CIA_PRB] & tmp)) {
+            for (m = 0x1, i = 0; i < 8; m <<= 1, i++) {
+                if (!(msk & m)) {
+                    tmp = matrix_get_active_columns_by_row(i);
+
+                    if ((cia_context->c_cia[CIA_DDRA] & ~cia_context->c_cia[CIA_PRA] & m) &&
+                        (cia_context->c_cia[CIA_DDRB] & cia_context->c_cia[CIA_PRB] & tmp)) {
+                        DBGB(("(%d)", i));
+                        if (ciapb_forcelow(i, (uint8_t)(cia_context->c_cia[CIA_DDRA] & ~cia_context->c_cia[CIA_PRA]))) {
+                            val_outhi &= ~tmp;
+                            DBGB(("<force low, val_outhi:%02x>", val_outhi));
+                        }
                     }
                 }
             }
@@ -408,18 +470,13 @@ static uint8_t read_ciapb(cia_context_t *cia_context)
     }
     DBGB((" val:%02x val_outhi:%02x", val, val_outhi));
 
-    /* loop over columns,
-       pull down all bits connected to a column which is output and active.
+    /* pull down all bits connected to a column which is output and active.
        handles the case when port b is used for both input and output
      */
     msk = cia_context->old_pb & read_joyport_dig(JOYPORT_1);
     DBGB((" oldpb: %02x msk: %02x", cia_context->old_pb, msk));
     if (c64keyboard_active) {
-        for (m = 0x1, i = 0; i < 8; m <<= 1, i++) {
-            if (!(msk & m)) {
-                val &= ~matrix_get_active_columns_by_column(i);
-            }
-        }
+        val &= ~matrix_cache.columns_by_columns[msk];
     }
 
     DBGB((" val:%02x", val));
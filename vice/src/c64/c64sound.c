@@ -215,7 +215,8 @@ static sound_chip_t sid_sound_chip = {
     sid_sound_machine_reset,             /* sound chip reset function */
     sid_sound_machine_cycle_based,       /* sound chip 'is_cycle_based()' function, resid engine is cycle based, all other engines are not */
     sid_sound_machine_channels,          /* sound chip 'get_amount_of_channels()' function, the amount of channels depends on the extra amount of active SIDs */
-    1                                    /* sound chip is always enabled */
+    1,                                   /* sound chip is always enabled */
+    1                                    /* sound chip writes are queued until the sound is run */
 };
 
 static uint16_t sid_sound_chip_offset = 0;
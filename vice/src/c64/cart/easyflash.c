@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "alarm.h"
 #include "archdep.h"
 #define CARTRIDGE_INCLUDE_SLOTMAIN_API
 #include "c64cartsystem.h"
@@ -44,6 +45,7 @@
 #include "flash040.h"
 #include "lib.h"
 #include "log.h"
+#include "machine.h"
 #include "maincpu.h"
 #include "mem.h"
 #include "monitor.h"
@@ -104,6 +106,21 @@ static uint8_t easyflash_ram[CART_RAM_SIZE];
 static char *easyflash_filename = NULL;
 static int easyflash_filetype = 0;
 
+/* a changed .bin is written back this many seconds after the first change */
+#define EASYFLASH_FLUSH_DELAY 2
+
+static alarm_t *easyflash_flush_alarm = NULL;
+static int easyflash_flush_pending = 0;
+
+#ifdef __LIBRETRO__
+/* sectors not yet saved to the image, kept over the detach that precedes
+   restoring a snapshot */
+static uint8_t easyflash_dirty_low[FLASH040_DIRTY_MASK_SIZE];
+static uint8_t easyflash_dirty_high[FLASH040_DIRTY_MASK_SIZE];
+static int easyflash_flash_dirty_low = 0;
+static int easyflash_flash_dirty_high = 0;
+#endif
+
 static const char STRING_EASYFLASH[] = CARTRIDGE_NAME_EASYFLASH;
 
 static const unsigned char eapiam29f040[768] = {
@@ -208,6 +225,44 @@ static const unsigned char eapiam29f040[768] = {
 
 /* ---------------------------------------------------------------------*/
 
+static void easyflash_flush_alarm_handler(CLOCK offset, void *data)
+{
+    alarm_unset(easyflash_flush_alarm);
+    easyflash_flush_pending = 0;
+
+    /* let an erase or a program command finish first */
+    if (easyflash_state_low->flash_state != FLASH040_STATE_READ
+        || easyflash_state_high->flash_state != FLASH040_STATE_READ) {
+        alarm_set(easyflash_flush_alarm, maincpu_clk + (CLOCK)machine_get_cycles_per_second());
+        easyflash_flush_pending = 1;
+        return;
+    }
+
+    if (easyflash_flush_image() < 0) {
+        log_error(LOG_DEFAULT, "EF: could not write back '%s'.", easyflash_filename);
+    }
+}
+
+/* Write a changed .bin back a little later, so that a crash or a lost
+   detach does not lose it; only the changed sectors are written. A .crt is
+   rewritten as a whole and is still only saved on detach.  */
+static void easyflash_schedule_flush(void)
+{
+    if (easyflash_flush_pending || !easyflash_crt_write
+        || easyflash_filetype != CARTRIDGE_FILETYPE_BIN
+        || (!easyflash_state_low->flash_dirty && !easyflash_state_high->flash_dirty)) {
+        return;
+    }
+
+    if (easyflash_flush_alarm == NULL) {
+        easyflash_flush_alarm = alarm_new(maincpu_alarm_context, "EasyFlashFlush", easyflash_flush_alarm_handler, NULL);
+    }
+    alarm_set(easyflash_flush_alarm, maincpu_clk + (CLOCK)machine_get_cycles_per_second() * EASYFLASH_FLUSH_DELAY);
+    easyflash_flush_pending = 1;
+}
+
+/* ---------------------------------------------------------------------*/
+
 static void easyflash_io1_store(uint16_t addr, uint8_t value)
 {
     uint8_t mem_mode;
@@ -395,6 +450,7 @@ uint8_t easyflash_roml_read(uint16_t addr)
 void easyflash_roml_store(uint16_t addr, uint8_t value)
 {
     flash040core_store(easyflash_state_low, (easyflash_register_00 * 0x2000) + (addr & 0x1fff), value);
+    easyflash_schedule_flush();
 }
 
 uint8_t easyflash_romh_read(uint16_t addr)
@@ -405,6 +461,7 @@ uint8_t easyflash_romh_read(uint16_t addr)
 void easyflash_romh_store(uint16_t addr, uint8_t value)
 {
     flash040core_store(easyflash_state_high, (easyflash_register_00 * 0x2000) + (addr & 0x1fff), value);
+    easyflash_schedule_flush();
 }
 
 void easyflash_mmu_translate(unsigned int addr, uint8_t **base, int *start, int *limit)
@@ -578,6 +635,15 @@ void easyflash_detach(void)
     if (easyflash_crt_write) {
         easyflash_flush_image();
     }
+    alarm_destroy(easyflash_flush_alarm);
+    easyflash_flush_alarm = NULL;
+    easyflash_flush_pending = 0;
+#ifdef __LIBRETRO__
+    memcpy(easyflash_dirty_low, easyflash_state_low->dirty_mask, FLASH040_DIRTY_MASK_SIZE);
+    memcpy(easyflash_dirty_high, easyflash_state_high->dirty_mask, FLASH040_DIRTY_MASK_SIZE);
+    easyflash_flash_dirty_low = easyflash_state_low->flash_dirty;
+    easyflash_flash_dirty_high = easyflash_state_high->flash_dirty;
+#endif
     flash040core_shutdown(easyflash_state_low);
     flash040core_shutdown(easyflash_state_high);
     lib_free(easyflash_state_low);
@@ -593,15 +659,71 @@ void easyflash_detach(void)
     export_remove(&export_res);
 }
 
+/* Rewrite only the 8KiB chunks of the .bin that lie in flash sectors changed
+   since the last save. Falls back to a full save if the file can't be
+   updated in place (missing, or not a plain 1MiB image). */
+static int easyflash_bin_update(const char *filename)
+{
+    FILE *fd;
+    int i;
+    unsigned int offset;
+
+    fd = fopen(filename, MODE_READ_WRITE);
+
+    if (fd == NULL) {
+        return easyflash_bin_save(filename);
+    }
+
+    if (archdep_file_size(fd) != (off_t)(0x4000 * EASYFLASH_N_BANKS)) {
+        fclose(fd);
+        return easyflash_bin_save(filename);
+    }
+
+    for (i = 0; i < EASYFLASH_N_BANKS; i++) {
+        offset = i * 0x2000;
+        if (flash040core_sector_is_dirty(easyflash_state_low, offset)) {
+            if ((fseek(fd, (long)(i * 0x4000), SEEK_SET) != 0)
+                || (fwrite(easyflash_state_low->flash_data + offset, 1, 0x2000, fd) != 0x2000)) {
+                fclose(fd);
+                return -1;
+            }
+        }
+        if (flash040core_sector_is_dirty(easyflash_state_high, offset)) {
+            if ((fseek(fd, (long)(i * 0x4000 + 0x2000), SEEK_SET) != 0)
+                || (fwrite(easyflash_state_high->flash_data + offset, 1, 0x2000, fd) != 0x2000)) {
+                fclose(fd);
+                return -1;
+            }
+        }
+    }
+
+    fclose(fd);
+    return 0;
+}
+
 int easyflash_flush_image(void)
 {
+    int res;
+
     if (easyflash_filename != NULL) {
+        /* nothing was erased or programmed since attach or the last save */
+        if (!easyflash_state_low->flash_dirty && !easyflash_state_high->flash_dirty) {
+            return 0;
+        }
         if (easyflash_filetype == CARTRIDGE_FILETYPE_BIN) {
-            return easyflash_bin_save(easyflash_filename);
+            res = easyflash_bin_update(easyflash_filename);
         } else if (easyflash_filetype == CARTRIDGE_FILETYPE_CRT) {
-            return easyflash_crt_save(easyflash_filename);
+            /* the chip packet layout depends on which banks are empty, so
+               a .crt always has to be written as a whole */
+            res = easyflash_crt_save(easyflash_filename);
+        } else {
+            return -1;
         }
-        return -1;
+        if (res == 0) {
+            flash040core_clear_dirty(easyflash_state_low);
+            flash040core_clear_dirty(easyflash_state_high);
+        }
+        return res;
     }
     return -2;
 }
@@ -801,10 +923,21 @@ int easyflash_snapshot_read_module(snapshot_t *s)
     }
 
 #ifdef __LIBRETRO__
-    if (easyflash_filename)
+    if (easyflash_filename) {
+        /* the flash contents are still the live image, keep what is not
+           saved yet */
+        memcpy(easyflash_state_low->dirty_mask, easyflash_dirty_low, FLASH040_DIRTY_MASK_SIZE);
+        memcpy(easyflash_state_high->dirty_mask, easyflash_dirty_high, FLASH040_DIRTY_MASK_SIZE);
+        easyflash_state_low->flash_dirty = easyflash_flash_dirty_low;
+        easyflash_state_high->flash_dirty = easyflash_flash_dirty_high;
         easyflash_common_attach(easyflash_filename);
-    else
+        easyflash_schedule_flush();
+    } else {
+        /* the banks were loaded from the snapshot */
+        flash040core_set_dirty(easyflash_state_low);
+        flash040core_set_dirty(easyflash_state_high);
         easyflash_common_attach("dummy");
+    }
 #else
     easyflash_common_attach("dummy");
 
@@ -330,6 +330,7 @@ static int sfx_soundsampler_sound_machine_init(sound_t *psid, int speed, int cyc
 static void sfx_soundsampler_sound_machine_store(sound_t *psid, uint16_t addr, uint8_t val)
 {
     snd.voice0 = val;
+    sound_dac_store(&sfx_soundsampler_dac, (int)val * 128);
 }
 
 static uint8_t sfx_soundsampler_sound_machine_read(sound_t *psid, uint16_t addr)
@@ -50,7 +50,8 @@ static sound_chip_t sid_sound_chip = {
     sid_sound_machine_reset,             /* sound chip reset function */
     sid_sound_machine_cycle_based,       /* sound chip 'is_cycle_based()' function, RESID engine is cycle based, everything else is NOT */
     sid_sound_machine_channels,          /* sound chip 'get_amount_of_channels()' function, depends on how many extra SIDs are active */
-    1                                    /* chip is always enabled */
+    1,                                   /* chip is always enabled */
+    1                                    /* sound chip writes are queued until the sound is run */
 };
 
 static uint16_t sid_sound_chip_offset = 0;
@@ -123,6 +123,8 @@ int c64dtv_snapshot_read(const char *name, int event_mode)
 
     joyport_clear_devices();
 
+    sound_snapshot_prepare();
+
     if (maincpu_snapshot_read_module(s) < 0
         || c64dtv_snapshot_read_module(s) < 0
         || c64dtvdma_snapshot_read_module(s) < 0
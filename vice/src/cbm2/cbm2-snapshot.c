@@ -111,6 +111,8 @@ int cbm2_snapshot_read(const char *name, int event_mode)
         goto fail;
     }
 
+    sound_snapshot_prepare();
+
     if (maincpu_snapshot_read_module(s) < 0
         || cbm2_snapshot_read_module(s) < 0
         || crtc_snapshot_read_module(s) < 0
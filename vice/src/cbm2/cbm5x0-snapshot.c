@@ -117,6 +117,8 @@ int cbm2_snapshot_read(const char *name, int event_mode)
 
     joyport_clear_devices();
 
+    sound_snapshot_prepare();
+
     if (maincpu_snapshot_read_module(s) < 0
         || vicii_snapshot_read_module(s) < 0
         || cbm2_c500_snapshot_read_module(s) < 0
@@ -304,6 +304,56 @@ static void cia_do_set_int(cia_context_t *cia_context, CLOCK rclk)
     cia_context->irqflags |= 0x80;
 }
 
+/*
+ * Timer alarms are only needed when something has to happen exactly at the
+ * underflow: an enabled (and not yet pending) interrupt, the serial port
+ * shifting out, or timer B counting timer A underflows.  Everything else
+ * (ICR flags, PB6/PB7, one-shot stop) is derived in closed form by
+ * ciat_update() when the registers are accessed.
+ */
+static inline int cia_ta_alarm_needed(cia_context_t *cia_context)
+{
+    return ((cia_context->c_cia[CIA_ICR] & CIA_IM_TA)
+            && !(cia_context->irqflags & 0x80))
+           || (cia_context->c_cia[CIA_CRA] & (CIA_CRA_SPMODE | CIA_CRA_INMODE))
+           || (cia_context->c_cia[CIA_CRB] & CIA_CRB_INMODE_TA);
+}
+
+static inline int cia_tb_alarm_needed(cia_context_t *cia_context)
+{
+    return (cia_context->c_cia[CIA_ICR] & CIA_IM_TB) != 0;
+}
+
+/* (re)schedule or drop the timer alarms, needs update before */
+static void cia_schedule_ta(cia_context_t *cia_context, CLOCK rclk)
+{
+    if (cia_ta_alarm_needed(cia_context)) {
+        ciat_set_alarm(cia_context->ta, rclk);
+    } else if (ciat_alarm_clk(cia_context->ta) != CLOCK_MAX) {
+        ciat_ack_alarm(cia_context->ta, rclk);
+    }
+}
+
+static void cia_schedule_tb(cia_context_t *cia_context, CLOCK rclk)
+{
+    if (cia_tb_alarm_needed(cia_context)) {
+        ciat_set_alarm(cia_context->tb, rclk);
+        return;
+    }
+
+    /* the timer B bug hides the flag from an ICR read one cycle before the
+       underflow, that needs the underflow to be evaluated on time */
+    if (cia_context->model == CIA_MODEL_6526
+        && ciat_next_underflow_clk(cia_context->tb) == cia_context->rdi + 1) {
+        ciat_set_alarm(cia_context->tb, rclk);
+        return;
+    }
+
+    if (ciat_alarm_clk(cia_context->tb) != CLOCK_MAX) {
+        ciat_ack_alarm(cia_context->tb, rclk);
+    }
+}
+
 /* -------------------------------------------------------------------------- */
 void ciacore_disable(cia_context_t *cia_context)
 {
@@ -493,18 +543,22 @@ static void ciacore_store_internal(cia_context_t *cia_context, uint16_t addr, ui
         case CIA_TAL:
             cia_update_ta(cia_context, rclk);
             ciat_set_latchlo(cia_context->ta, rclk, (uint8_t)byte);
+            cia_schedule_ta(cia_context, rclk);
             break;
         case CIA_TBL:
             cia_update_tb(cia_context, rclk);
             ciat_set_latchlo(cia_context->tb, rclk, (uint8_t)byte);
+            cia_schedule_tb(cia_context, rclk);
             break;
         case CIA_TAH:
             cia_update_ta(cia_context, rclk);
             ciat_set_latchhi(cia_context->ta, rclk, (uint8_t)byte);
+            cia_schedule_ta(cia_context, rclk);
             break;
         case CIA_TBH:
             cia_update_tb(cia_context, rclk);
             ciat_set_latchhi(cia_context->tb, rclk, (uint8_t)byte);
+            cia_schedule_tb(cia_context, rclk);
             break;
 
         /*
@@ -621,12 +675,8 @@ static void ciacore_store_internal(cia_context_t *cia_context, uint16_t addr, ui
                 cia_do_set_int(cia_context, rclk + 1);
             }
 
-            if (cia_context->c_cia[CIA_ICR] & CIA_IM_TA) {
-                ciat_set_alarm(cia_context->ta, rclk);
-            }
-            if (cia_context->c_cia[CIA_ICR] & CIA_IM_TB) {
-                ciat_set_alarm(cia_context->tb, rclk);
-            }
+            cia_schedule_ta(cia_context, rclk);
+            cia_schedule_tb(cia_context, rclk);
 
             CIAT_LOGOUT((""));
             break;
@@ -675,6 +725,7 @@ static void ciacore_store_internal(cia_context_t *cia_context, uint16_t addr, ui
 #endif
             cia_context->c_cia[addr] = byte & 0xef;    /* remove strobe */
 
+            cia_schedule_ta(cia_context, rclk);
             ciacore_update_papb(cia_context, rclk);
             break;
 
@@ -713,6 +764,7 @@ static void ciacore_store_internal(cia_context_t *cia_context, uint16_t addr, ui
 
             cia_context->c_cia[addr] = byte & 0xef;    /* remove strobe */
 
+            cia_schedule_tb(cia_context, rclk);
             ciacore_update_papb(cia_context, rclk);
             break;
 
@@ -901,13 +953,6 @@ uint8_t cia_read_(cia_context_t *cia_context, uint16_t addr)
                 }
 #endif
 
-                ciat_set_alarm(cia_context->ta, rclk);
-                ciat_set_alarm(cia_context->tb, rclk);
-
-                CIAT_LOG(("read_icr -> ta alarm at %lu, tb at %lu",
-                          ciat_alarm_clk(cia_context->ta),
-                          ciat_alarm_clk(cia_context->tb)));
-
                 if (cia_context->irqflags & CIA_IM_TBB) {
                     /* timer b bug */
                     cia_context->irqflags &= ~(CIA_IM_TBB | CIA_IM_TB);
@@ -922,6 +967,15 @@ uint8_t cia_read_(cia_context_t *cia_context, uint16_t addr)
                 cia_context->irqflags = 0;
                 my_set_int(cia_context, 0, rclk);
 
+                /* only re-arm the timers whose underflow has to be seen on
+                   time, polling loops on the ICR must not cause alarm churn */
+                cia_schedule_ta(cia_context, rclk);
+                cia_schedule_tb(cia_context, rclk);
+
+                CIAT_LOG(("read_icr -> ta alarm at %lu, tb at %lu",
+                          ciat_alarm_clk(cia_context->ta),
+                          ciat_alarm_clk(cia_context->tb)));
+
                 CIAT_LOGOUT((""));
 
                 cia_context->last_read = t;
@@ -1049,10 +1103,7 @@ static void ciacore_intta(CLOCK offset, void *data)
             == (CIA_CRA_INMODE_PHI2|CIA_CR_RUNMODE_CONTINUOUS|CIA_CR_START)) {
         /* if we do not need alarm, no PB6, no shift register, and not timer B
            counting timer A, then we can safely skip alarms... */
-        if (((cia_context->c_cia[CIA_ICR] & CIA_IM_TA) &&
-             (!(cia_context->irqflags & 0x80)))
-            || (cia_context->c_cia[CIA_CRA] & (CIA_CRA_SPMODE|CIA_CRA_INMODE)) /* != CIA_CRA_SPMODE_IN|CIA_CRA_INMODE_PHI2 */
-            || (cia_context->c_cia[CIA_CRB] & CIA_CRB_INMODE_TA)) {
+        if (cia_ta_alarm_needed(cia_context)) {
             ciat_set_alarm(cia_context->ta, rclk);
         }
     }
@@ -1153,7 +1204,7 @@ static void ciacore_inttb(CLOCK offset, void *data)
     if ((cia_context->c_cia[CIA_CRB] & (CIA_CRB_INMODE|CIA_CR_RUNMODE|CIA_CR_START)) ==
             (CIA_CRB_INMODE_PHI2|CIA_CR_RUNMODE_CONTINUOUS|CIA_CR_START)) {
         /* if no interrupt flag we can safely skip alarms */
-        if (cia_context->c_cia[CIA_ICR] & CIA_IM_TB) {
+        if (cia_tb_alarm_needed(cia_context)) {
             ciat_set_alarm(cia_context->tb, rclk);
         }
     }
@@ -1302,6 +1353,11 @@ static void ciacore_inttod(CLOCK offset, void *data)
        also introduce some kind of randomness to mimic realistic behaviour.
 
        for some details (german) http://www.netzfrequenzmessung.de/
+
+       note that the jitter is drawn from the shared pseudo random generator,
+       which is also used by e.g. the drive rotation code. the alarm therefore
+       has to fire on every power tick, even while the TOD is stopped or never
+       read, or the sequence seen by the other users would change.
      */
     cia_context->todticks = cia_context->ticks_per_sec / cia_context->power_freq;
     tclk = ((cia_context->power_tickcounter * cia_context->ticks_per_sec) / cia_context->power_freq);
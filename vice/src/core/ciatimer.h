@@ -150,18 +150,15 @@ struct snapshot_module_s;
 
 #if defined INLINE_CIAT_FUNCS || defined _CIATIMER_C
 
-/* check when the next underflow will occur and set the alarm */
+/* check when the next underflow will occur, CLOCK_MAX if never */
 /* needs update before */
-_CIAT_FUNC void ciat_set_alarm(ciat_t *state, CLOCK cclk)
+_CIAT_FUNC CLOCK ciat_next_underflow_clk(ciat_t *state)
 {
     CLOCK tmp = 0;
     CLOCK aclk = state->clk;
     uint16_t cnt = state->cnt;
     ciat_tstate_t t = state->state;
 
-    CIAT_LOGIN(("%s set_alarm: cclk=%lu, latch=%d",
-                state->name, cclk, state->latch));
-
     while (1) {
         CIAT_LOG(("- state->clk=%lu cnt=%d state=%04x", aclk, cnt, t));
 
@@ -211,10 +208,21 @@ _CIAT_FUNC void ciat_set_alarm(ciat_t *state, CLOCK cclk)
             t &= ~(CIAT_CR_START | CIAT_COUNT2);
         }
     }
-/*
-    CIAT_LOG(("-> state->clk=%d cnt=%d, latch=%d, state=%04x",
-                state->clk, state->cnt, state->latch, t));
-*/
+
+    return tmp;
+}
+
+/* check when the next underflow will occur and set the alarm */
+/* needs update before */
+_CIAT_FUNC void ciat_set_alarm(ciat_t *state, CLOCK cclk)
+{
+    CLOCK tmp;
+
+    CIAT_LOGIN(("%s set_alarm: cclk=%lu, latch=%d",
+                state->name, cclk, state->latch));
+
+    tmp = ciat_next_underflow_clk(state);
+
     CIAT_LOG((" -> alarmclk=%d", tmp));
 
     state->alarmclk = tmp;
@@ -232,6 +240,17 @@ _CIAT_FUNC CLOCK ciat_alarm_clk(ciat_t *state)
     return state->alarmclk;
 }
 
+_CIAT_FUNC void ciat_ack_alarm(ciat_t *state, CLOCK cclk)
+{
+    CIAT_LOGIN(("%s ack_alarm: cclk=%lu, alarmclk=%lu",
+                state->name, cclk, state->alarmclk));
+
+    alarm_unset(state->alarm);
+    state->alarmclk = CLOCK_MAX;
+
+    CIAT_LOGOUT((""));
+}
+
 
 _CIAT_FUNC int ciat_update(ciat_t *state, CLOCK cclk)
 {
@@ -397,8 +416,7 @@ _CIAT_FUNC void ciat_set_latchhi(ciat_t *state, CLOCK cclk, uint8_t byte)
         state->cnt = state->latch;
     }
 
-    /* just in case we have an underflow or force load and a scheduled alarm */
-    ciat_set_alarm(state, cclk);
+    /* the caller has to reschedule (or drop) the alarm */
 
     CIAT_LOGOUT((""));
 }
@@ -412,14 +430,13 @@ _CIAT_FUNC void ciat_set_latchlo(ciat_t *state, CLOCK cclk, uint8_t byte)
         state->cnt = (state->cnt & 0xff00) | byte;
     }
 
-    /* just in case we have an underflow or force load and a scheduled alarm */
-    ciat_set_alarm(state, cclk);
+    /* the caller has to reschedule (or drop) the alarm */
 
     CIAT_LOGOUT((""));
 }
 
 
-/* needs update before */
+/* needs update before, does not touch the alarm */
 _CIAT_FUNC void ciat_set_ctrl(ciat_t *state, CLOCK cclk, uint8_t byte)
 {
     CIAT_LOGIN(("%s set_ctrl: cclk=%lu, byte=%02x",
@@ -428,18 +445,7 @@ _CIAT_FUNC void ciat_set_ctrl(ciat_t *state, CLOCK cclk, uint8_t byte)
     /* bit 0= start/stop, 3=oneshot 4=force load, 5=0:count phi2 1:singlestep */ state->state &= ~(CIAT_CR_MASK);
     state->state |= (byte & CIAT_CR_MASK) ^ CIAT_PHI2IN;
 
-    ciat_set_alarm(state, cclk);
-
-    CIAT_LOGOUT((""));
-}
-
-_CIAT_FUNC void ciat_ack_alarm(ciat_t *state, CLOCK cclk)
-{
-    CIAT_LOGIN(("%s ack_alarm: cclk=%lu, alarmclk=%lu",
-                state->name, cclk, state->alarmclk));
-
-    alarm_unset(state->alarm);
-    state->alarmclk = CLOCK_MAX;
+    /* the caller has to reschedule (or drop) the alarm */
 
     CIAT_LOGOUT((""));
 }
@@ -458,6 +464,7 @@ extern uint16_t ciat_read_timer(ciat_t *state, CLOCK cclk);
 extern uint16_t ciat_read_latch(ciat_t *state, CLOCK cclk);
 extern int ciat_update(ciat_t *state, CLOCK cclk);
 extern CLOCK ciat_alarm_clk(ciat_t *state);
+extern CLOCK ciat_next_underflow_clk(ciat_t *state);
 extern void ciat_set_alarm(ciat_t *state, CLOCK clk);
 
 extern uint16_t ciat_is_underflow_clk(ciat_t *state, CLOCK cclk);
@@ -149,6 +149,12 @@ inline static void flash_add_sector_to_erase_mask(flash040_context_t *flash040_c
     flash040_context->erase_mask[sector_num >> 3] |= (uint8_t)(1 << (sector_num & 0x7));
 }
 
+inline static void flash_set_sector_dirty(flash040_context_t *flash040_context, unsigned int sector_num)
+{
+    flash040_context->dirty_mask[sector_num >> 3] |= (uint8_t)(1 << (sector_num & 0x7));
+    flash040_context->flash_dirty = 1;
+}
+
 inline static void flash_erase_sector(flash040_context_t *flash040_context, unsigned int sector)
 {
     unsigned int sector_size = flash_types[flash040_context->flash_type].sector_size;
@@ -158,14 +164,14 @@ inline static void flash_erase_sector(flash040_context_t *flash040_context, unsi
 
     FLASH_DEBUG(("Erasing 0x%x - 0x%x", sector_addr, sector_addr + sector_size - 1));
     memset(&(flash040_context->flash_data[sector_addr]), 0xff, sector_size);
-    flash040_context->flash_dirty = 1;
+    flash_set_sector_dirty(flash040_context, sector);
 }
 
 inline static void flash_erase_chip(flash040_context_t *flash040_context)
 {
     FLASH_DEBUG(("Erasing chip"));
     memset(flash040_context->flash_data, 0xff, flash_types[flash040_context->flash_type].size);
-    flash040_context->flash_dirty = 1;
+    flash040core_set_dirty(flash040_context);
 }
 
 inline static int flash_program_byte(flash040_context_t *flash040_context, unsigned int addr, uint8_t byte)
@@ -176,7 +182,7 @@ inline static int flash_program_byte(flash040_context_t *flash040_context, unsig
     FLASH_DEBUG(("Programming 0x%05x with 0x%02x (%02x->%02x)", addr, byte, old_data, old_data & byte));
     flash040_context->program_byte = byte;
     flash040_context->flash_data[addr] = new_data;
-    flash040_context->flash_dirty = 1;
+    flash_set_sector_dirty(flash040_context, flash_addr_to_sector_number(flash040_context, addr));
 
     return (new_data == byte) ? 1 : 0;
 }
@@ -487,7 +493,7 @@ void flash040core_init(struct flash040_context_s *flash040_context,
     flash040_context->flash_base_state = FLASH040_STATE_READ;
     flash040_context->program_byte = 0;
     flash_clear_erase_mask(flash040_context);
-    flash040_context->flash_dirty = 0;
+    flash040core_clear_dirty(flash040_context);
     flash040_context->erase_alarm = alarm_new(alarm_context, "Flash040Alarm", erase_alarm_handler, flash040_context);
 }
 
@@ -498,6 +504,29 @@ void flash040core_shutdown(flash040_context_t *flash040_context)
 
 /* -------------------------------------------------------------------------- */
 
+/* Dirty sector tracking, so that users can save only what has changed. */
+
+int flash040core_sector_is_dirty(flash040_context_t *flash040_context, unsigned int addr)
+{
+    unsigned int sector_num = flash_addr_to_sector_number(flash040_context, addr);
+
+    return (flash040_context->dirty_mask[sector_num >> 3] >> (sector_num & 0x7)) & 1;
+}
+
+void flash040core_set_dirty(flash040_context_t *flash040_context)
+{
+    memset(flash040_context->dirty_mask, 0xff, FLASH040_DIRTY_MASK_SIZE);
+    flash040_context->flash_dirty = 1;
+}
+
+void flash040core_clear_dirty(flash040_context_t *flash040_context)
+{
+    memset(flash040_context->dirty_mask, 0, FLASH040_DIRTY_MASK_SIZE);
+    flash040_context->flash_dirty = 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
 #define FLASH040_DUMP_VER_MAJOR   2
 #define FLASH040_DUMP_VER_MINOR   0
 
@@ -52,7 +52,11 @@
 
 /* #define T6721DEBUG */
 
+#ifdef __LIBRETRO__
+#define WRITEWAVFILE 0
+#else
 #define WRITEWAVFILE 1 /* write "test.wav" containing all generated output */
+#endif
 
 #ifdef T6721DEBUG
 #define DBG(x) DBG_STATUS(); printf x;
@@ -384,20 +388,13 @@ static int get_subframe_samples(t6721_state *t6721)
     PARCOR Synthesis
 *****************************************************************************/
 
-static double filter(int i, double ef, double k)
-{
-    double ef_prev = ef + k * p_z[1 + i - 1];
-    p_z[1 + i] = p_z[1 + i - 1] - k * ef_prev;
-    return ef_prev;
-}
-
 /* -------------------------------------------------------------------------
     render one PARCOR subframe
     returns 1 on error, 0 on success
    ------------------------------------------------------------------------- */
 static int render_subframe(t6721_state *t6721, int sub_i, int voiced)
 {
-    int i, j;
+    int i, j, num;
     static double phase = 0.0;
 
     double energy = ((p_from.energy * (8 - sub_i)) + (p_to.energy * sub_i)) / (8.0 * 127.0);
@@ -405,6 +402,7 @@ static int render_subframe(t6721_state *t6721, int sub_i, int voiced)
     double phase_inc;
 
     double k[10];
+    double z[11];
 
     double sample, data;
 
@@ -426,7 +424,11 @@ static int render_subframe(t6721_state *t6721, int sub_i, int voiced)
     }
 /* DBGADD(("\n")); */
 
-    for (i = 0; i < get_subframe_samples(t6721); ++i) {
+    /* run the lattice on a local copy of its state */
+    memcpy(z, p_z, sizeof(z));
+    num = get_subframe_samples(t6721);
+
+    for (i = 0; i < num; ++i) {
         /* sample */
         if (voiced) {
             phase += phase_inc;
@@ -444,25 +446,29 @@ static int render_subframe(t6721_state *t6721, int sub_i, int voiced)
         /* filter */
         data = sample;
         for (j = t6721->cond2_stages - 1; j >= 0; --j) {
-            data = filter(j, data, k[j]);
+            data = data + k[j] * z[j];
+            z[j + 1] = z[j] - k[j] * data;
         }
 
         /* scale to 16bit */
         output = (int16_t)(data * (8192.0f + 2048.0f));
 
         if (parcor_output_sample(t6721, output)) {
+            memcpy(p_z, z, sizeof(z));
             return 1;
         }
     }
 
+    memcpy(p_z, z, sizeof(z));
     return 0;
 }
 
 static int render_silence(t6721_state *t6721)
 {
-    int i;
+    int i, num;
 
-    for (i = 0; i < (get_subframe_samples(t6721) * 8); ++i) {
+    num = get_subframe_samples(t6721) * 8;
+    for (i = 0; i < num; ++i) {
         if (parcor_output_sample(t6721, 0)) {
             return 1;
         }
@@ -759,13 +765,61 @@ void t6721_update_tick(t6721_state *t6721)
     }
 }
 
+/*
+    number of the next ticks that only count down eos_samples, playing_delay
+    or phrase_samples, and so can be run in one go
+*/
+static int idle_ticks(t6721_state *t6721, int ticks)
+{
+    int n = ticks;
+
+    if (t6721->eos_samples) {
+        if (n > t6721->eos_samples) {
+            n = t6721->eos_samples;
+        }
+    } else if (t6721->eos) {
+        /* EOS is deasserted on the next tick */
+        return 0;
+    }
+
+    if (t6721->playing_delay) {
+        if (n > t6721->playing_delay) {
+            n = t6721->playing_delay;
+        }
+    } else if (phrase_samples) {
+        if (n > phrase_samples) {
+            n = phrase_samples;
+        }
+    } else if ((t6721->playing == 1) && (t6721->apd == 0) && (t6721->eos == 0)) {
+        /* reads from the DI line */
+        return 0;
+    }
+
+    return n;
+}
+
 /* run chip for N CPU/System Cycles */
 void t6721_update_ticks(t6721_state *t6721, int ticks)
 {
-    while (ticks) {
-        t6721_update_tick(t6721);
-        t6721->cycles_done++;
-        ticks--;
+    int n;
+
+    while (ticks > 0) {
+        n = idle_ticks(t6721, ticks);
+        if (n == 0) {
+            t6721_update_tick(t6721);
+            n = 1;
+        } else {
+            if (t6721->eos_samples) {
+                t6721->eos_samples -= n;
+            }
+            if (t6721->playing_delay) {
+                t6721->playing_delay -= n;
+            } else if (phrase_samples) {
+                phrase_samples -= n;
+            }
+        }
+        t6721->cycles_done += n;
+        ticks -= n;
     }
 }
 
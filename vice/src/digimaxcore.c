@@ -116,6 +116,7 @@ static void digimax_sound_machine_store(sound_t *psid, uint16_t addr, uint8_t va
             snd.voice3 = val;
             break;
     }
+    sound_dac_store(&digimax_dac[addr & 3], (int)val * 64);
 }
 
 static uint8_t digimax_sound_machine_read(sound_t *psid, uint16_t addr)
@@ -1062,6 +1062,16 @@ static int drive_snapshot_read_gcrimage_module(snapshot_t *s, unsigned int dnr)
 #define P64IMAGE_SNAP_MAJOR 1
 #define P64IMAGE_SNAP_MINOR 0
 
+/* The raw P64 data only lives until it has been parsed, use the snapshot
+   scratch arena where available.  */
+#ifdef __LIBRETRO__
+#define P64_TMPBUF_ALLOC(size)  snapshot_temp_alloc(size)
+#define P64_TMPBUF_FREE(ptr)    snapshot_temp_free(ptr)
+#else
+#define P64_TMPBUF_ALLOC(size)  lib_malloc(size)
+#define P64_TMPBUF_FREE(ptr)    lib_free(ptr)
+#endif
+
 static int drive_snapshot_write_p64image_module(snapshot_t *s, unsigned int dnr)
 {
     char snap_module_name[10];
@@ -1163,13 +1173,13 @@ static int drive_snapshot_read_p64image_module(snapshot_t *s, unsigned int dnr)
         return -1;
     }
 
-    tmpbuf = lib_malloc(size);
+    tmpbuf = P64_TMPBUF_ALLOC(size);
 
     if (SMR_BA(m, tmpbuf, size) < 0) {
         if (m != NULL) {
             snapshot_module_close(m);
         }
-        lib_free(tmpbuf);
+        P64_TMPBUF_FREE(tmpbuf);
         return -1;
     }
 
@@ -1181,7 +1191,7 @@ static int drive_snapshot_read_p64image_module(snapshot_t *s, unsigned int dnr)
         if (m != NULL) {
             snapshot_module_close(m);
         }
-        lib_free(tmpbuf);
+        P64_TMPBUF_FREE(tmpbuf);
         P64MemoryStreamDestroy(&P64MemoryStreamInstance);
         return -1;
     }
@@ -1191,7 +1201,7 @@ static int drive_snapshot_read_p64image_module(snapshot_t *s, unsigned int dnr)
     snapshot_module_close(m);
     m = NULL;
 
-    lib_free(tmpbuf);
+    P64_TMPBUF_FREE(tmpbuf);
 
     drive->P64_image_loaded = 1;
     drive->complicated_image_loaded = 1;
@@ -410,6 +410,15 @@ void drivecpu_execute(diskunit_context_t *drv, CLOCK clk_value)
 
 #define CALLER (cpu->monspace)
 
+#if defined(__LIBRETRO__) && defined(HAVE_BINARY_MONITOR)
+/* The binary monitor stopped the machine: leave before the instruction,
+   the drive catches up with the main CPU once the machine is resumed.  */
+#define LEAVE_IF_MONITOR_STOPPED       \
+    if (monitor_binary_hold(CALLER)) { \
+        break;                         \
+    }
+#endif
+
 #define DMA_FUNC drive_generic_dma()
 
 #define DMA_ON_RESET
@@ -39,6 +39,8 @@
 
 const int fdd_data_rates[4] = { 500, 300, 250, 1000 }; /* kbit/s */
 #define INDEXLEN (16)
+#define TRACK_CACHE_SIZE (8)
+#define TRACK_MAX_SECTORS (20)
 static void fdd_flush_raw(fd_drive_t *drv);
 static uint16_t *crc1021 = NULL;
 
@@ -72,10 +74,85 @@ struct fd_drive_s {
         uint8_t *data;
         uint8_t *sync;
     } raw;
+    /* clean MFM encodings of recently used tracks, so that stepping back
+       to a track doesn't need to synthesize it again from the image */
+    struct {
+        int track_head; /* -1 if unused */
+        unsigned int used;
+        int offset[TRACK_MAX_SECTORS]; /* raw offset of each sector's data */
+        uint8_t *data;
+        uint8_t *sync;
+    } cache[TRACK_CACHE_SIZE];
+    unsigned int cache_clock;
+    int cache_current; /* cache entry of the track in raw, or -1 */
 };
 
+static void fdd_cache_invalidate(fd_drive_t *drv)
+{
+    int i;
+
+    for (i = 0; i < TRACK_CACHE_SIZE; i++) {
+        drv->cache[i].track_head = -1;
+    }
+    drv->cache_current = -1;
+}
+
+static void fdd_cache_free(fd_drive_t *drv)
+{
+    int i;
+
+    for (i = 0; i < TRACK_CACHE_SIZE; i++) {
+        lib_free(drv->cache[i].data);
+        drv->cache[i].data = NULL;
+        lib_free(drv->cache[i].sync);
+        drv->cache[i].sync = NULL;
+    }
+    fdd_cache_invalidate(drv);
+}
+
+static int fdd_cache_lookup(fd_drive_t *drv, int track_head)
+{
+    int i;
+
+    for (i = 0; i < TRACK_CACHE_SIZE; i++) {
+        if (drv->cache[i].track_head == track_head) {
+            drv->cache[i].used = ++drv->cache_clock;
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* store the freshly synthesized track in raw, replacing the least recently
+   used entry */
+static int fdd_cache_store(fd_drive_t *drv, const int *offset)
+{
+    int i, victim = 0;
+
+    for (i = 0; i < TRACK_CACHE_SIZE; i++) {
+        if (drv->cache[i].track_head < 0) {
+            victim = i;
+            break;
+        }
+        if (drv->cache[i].used < drv->cache[victim].used) {
+            victim = i;
+        }
+    }
+    if (drv->cache[victim].data == NULL) {
+        drv->cache[victim].data = lib_malloc((size_t)(drv->raw.size));
+        drv->cache[victim].sync = lib_malloc((size_t)((drv->raw.size + 7) >> 3));
+    }
+    memcpy(drv->cache[victim].data, drv->raw.data, (size_t)(drv->raw.size));
+    memcpy(drv->cache[victim].sync, drv->raw.sync, (size_t)((drv->raw.size + 7) >> 3));
+    memcpy(drv->cache[victim].offset, offset, sizeof(drv->cache[victim].offset));
+    drv->cache[victim].track_head = drv->raw.track_head;
+    drv->cache[victim].used = ++drv->cache_clock;
+    return victim;
+}
+
 fd_drive_t *fdd_init(int num, drive_t *drive)
 {
+    int i;
     fd_drive_t *drv = lib_malloc(sizeof(fd_drive_t));
     drv->myname = lib_msprintf("FDD%d", num);
     drv->image = NULL;
@@ -95,6 +172,13 @@ fd_drive_t *fdd_init(int num, drive_t *drive)
     drv->raw.data = NULL;
     drv->raw.sync = NULL;
     drv->write_beyond = 0;
+    for (i = 0; i < TRACK_CACHE_SIZE; i++) {
+        drv->cache[i].data = NULL;
+        drv->cache[i].sync = NULL;
+        drv->cache[i].used = 0;
+    }
+    drv->cache_clock = 0;
+    fdd_cache_invalidate(drv);
     return drv;
 }
 
@@ -123,6 +207,7 @@ void fdd_shutdown(fd_drive_t *drv)
     if (!drv) {
         return;
     }
+    fdd_cache_free(drv);
     lib_free(drv->myname);
     lib_free(drv);
 }
@@ -191,6 +276,7 @@ void fdd_image_attach(fd_drive_t *drv, struct disk_image_s *image)
     drv->raw.dirty = 0;
     drv->raw.head = 0;
     drv->write_beyond = 0;
+    fdd_cache_free(drv);
 
     drv->disk_change = 1;
     drv->write_protect = (int)(image->read_only);
@@ -207,6 +293,7 @@ void fdd_image_detach(fd_drive_t *drv)
     drv->raw.data = NULL;
     lib_free(drv->raw.sync);
     drv->raw.sync = NULL;
+    fdd_cache_free(drv);
     drv->disk_change = 1;
 }
 
@@ -240,8 +327,10 @@ inline uint16_t fdd_crc(uint16_t crc, uint8_t b)
 
 static void fdd_flush_raw(fd_drive_t *drv)
 {
-    int i, j, s, p, step, d, c;
+    int i, j, s, p, step, d, c, changed, written = 0;
     uint8_t *data;
+    const uint8_t *clean = NULL;
+    const int *offset = NULL;
     uint16_t w;
     disk_addr_t dadr;
 
@@ -250,6 +339,16 @@ static void fdd_flush_raw(fd_drive_t *drv)
     }
     drv->raw.dirty = 0;
 
+    /* sectors whose bytes still match the clean encoding of the track
+       are unchanged in the image, and need not be written back. Compare
+       against the data where it was synthesized, as a format may have
+       moved the sectors around the track. */
+    if (drv->cache_current >= 0
+        && drv->cache[drv->cache_current].track_head == drv->raw.track_head) {
+        clean = drv->cache[drv->cache_current].data;
+        offset = drv->cache[drv->cache_current].offset;
+    }
+
     if (drv->raw.track_head / 2 < drv->tracks && drv->image) {
 #ifdef FDD_DEBUG
         for (i = 0; i < drv->raw.size; i++) {
@@ -267,6 +366,7 @@ static void fdd_flush_raw(fd_drive_t *drv)
         for (s = 0; s < drv->sectors; s++) {
             step = 0;
             d = 0;
+            changed = (clean == NULL);
             for (i = 0; i < drv->raw.size * 2; i++) {
                 w = drv->raw.data[p];
                 if (drv->raw.sync[p >> 3] & (0x80 >> (p & 7))) {
@@ -355,6 +455,10 @@ static void fdd_flush_raw(fd_drive_t *drv)
                         }
                         break;
                     case 12:
+                        if (!changed
+                            && clean[(offset[s] + d) % drv->raw.size] != (uint8_t)w) {
+                            changed = 1;
+                        }
                         data[d++] = (uint8_t)w;
                         if (d >= (128 << drv->sector_size)) {
                             step++;
@@ -385,7 +489,10 @@ static void fdd_flush_raw(fd_drive_t *drv)
                                     }
                                 }
                             } else {
-                                disk_image_write_sector(drv->image, data + j * 128, &dadr);
+                                if (changed) {
+                                    disk_image_write_sector(drv->image, data + j * 128, &dadr);
+                                    written = 1;
+                                }
                                 drv->write_beyond = 0;
                             }
                             dadr.sector = (dadr.sector + 1) % (unsigned int)(drv->image_sectors);
@@ -403,11 +510,22 @@ static void fdd_flush_raw(fd_drive_t *drv)
         }
         lib_free(data);
     }
+
+    /* the image no longer matches the cached encoding of this track */
+    if (written || clean == NULL) {
+        for (i = 0; i < TRACK_CACHE_SIZE; i++) {
+            if (drv->cache[i].track_head == drv->raw.track_head) {
+                drv->cache[i].track_head = -1;
+            }
+        }
+        drv->cache_current = -1;
+    }
 }
 
 static void fdd_update_raw(fd_drive_t *drv)
 {
-    int i, j, s, p, res;
+    int i, j, s, p, res, cacheable = 1;
+    int offset[TRACK_MAX_SECTORS];
     uint8_t buffer[256];
     uint16_t crc;
     disk_addr_t dadr;
@@ -420,6 +538,13 @@ static void fdd_update_raw(fd_drive_t *drv)
     }
     drv->raw.track_head = drv->track * 2 + drv->head;
 
+    drv->cache_current = fdd_cache_lookup(drv, drv->raw.track_head);
+    if (drv->cache_current >= 0) {
+        memcpy(drv->raw.data, drv->cache[drv->cache_current].data, (size_t)(drv->raw.size));
+        memcpy(drv->raw.sync, drv->cache[drv->cache_current].sync, (size_t)((drv->raw.size + 7) >> 3));
+        return;
+    }
+
     memset(drv->raw.data, 0x4e, (size_t)(drv->raw.size));
     memset(drv->raw.sync, 0, (size_t)((drv->raw.size + 7) >> 3));
 
@@ -473,6 +598,8 @@ static void fdd_update_raw(fd_drive_t *drv)
                    track read. We do this by not creating the MFM structure for
                    the whole track. */
                 if (dadr.track >= 81 && drv->image->type == DISK_IMAGE_TYPE_D81) {
+                    /* depends on write_beyond, so never cached */
+                    cacheable = 0;
                     if (drv->write_beyond) {
                         /* remove all MFM data from the track */
                         memset(drv->raw.data, 0x4e, (size_t)(drv->raw.size));
@@ -496,6 +623,7 @@ static void fdd_update_raw(fd_drive_t *drv)
                         fdd_raw_write_sync(0xa1);
                     }
                     fdd_raw_write(0xfb); /* Data mark */
+                    offset[s] = p;
                 }
                 for (i = 0; i < 256; i++) {
                     fdd_raw_write(buffer[i]);
@@ -512,6 +640,9 @@ static void fdd_update_raw(fd_drive_t *drv)
                 fdd_raw_write(0x4e); /* GAP 3 */
             }
         }
+        if (cacheable) {
+            drv->cache_current = fdd_cache_store(drv, offset);
+        }
 #ifdef FDD_DEBUG
         for (i = 0; i < drv->raw.size; i++) {
             if (!(i & 15)) {
@@ -692,6 +823,11 @@ void fdd_set_motor(fd_drive_t *drv, int motor)
     if (!drv) {
         return;
     }
+    if (!drv->motor && (motor & 1)) {
+        /* the image may have been changed behind our back (e.g. by the
+           virtual drive) while the motor was off */
+        fdd_cache_invalidate(drv);
+    }
     drv->motor = motor & 1;
 }
 
@@ -815,6 +951,7 @@ int fdd_snapshot_read_module(fd_drive_t *drv, struct snapshot_s *s)
     drv->raw.data = lib_malloc((size_t)drv->raw.size);
     lib_free(drv->raw.sync);
     drv->raw.sync = lib_malloc((size_t)((drv->raw.size + 7) >> 3));
+    fdd_cache_free(drv);
 
     if (0
         || SMR_BA(m, drv->raw.data, (unsigned int)drv->raw.size) < 0
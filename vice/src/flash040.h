@@ -61,6 +61,7 @@ enum flash040_state_s {
 typedef enum flash040_state_s flash040_state_t;
 
 #define FLASH040_ERASE_MASK_SIZE 8
+#define FLASH040_DIRTY_MASK_SIZE 16
 
 typedef struct flash040_context_s {
     uint8_t *flash_data;
@@ -70,6 +71,7 @@ typedef struct flash040_context_s {
     uint8_t program_byte;
     uint8_t erase_mask[FLASH040_ERASE_MASK_SIZE];
     int flash_dirty;
+    uint8_t dirty_mask[FLASH040_DIRTY_MASK_SIZE];   /* sectors changed since the last save */
 
     flash040_type_t flash_type;
 
@@ -92,6 +94,11 @@ extern uint8_t flash040core_read(struct flash040_context_s *flash040_context,
 extern uint8_t flash040core_peek(struct flash040_context_s *flash040_context,
                               unsigned int addr);
 
+extern int flash040core_sector_is_dirty(struct flash040_context_s *flash040_context,
+                                        unsigned int addr);
+extern void flash040core_set_dirty(struct flash040_context_s *flash040_context);
+extern void flash040core_clear_dirty(struct flash040_context_s *flash040_context);
+
 struct snapshot_s;
 
 extern int flash040core_snapshot_write_module(struct snapshot_s *s,
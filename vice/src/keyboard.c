@@ -98,6 +98,7 @@ static log_t keyboard_log = LOG_DEFAULT;
    latch_keyarr or network_keyarr. */
 int keyarr[KBD_ROWS];
 int rev_keyarr[KBD_COLS];
+unsigned int keyarr_serial = 0;
 
 /* Keyboard status to be latched into the keyboard array.  */
 static int latch_keyarr[KBD_ROWS];
@@ -185,6 +186,7 @@ void keyboard_clear_keymatrix(void)
 {
     memset(keyarr, 0, sizeof(keyarr));
     memset(rev_keyarr, 0, sizeof(rev_keyarr));
+    keyarr_serial++;
     memset(latch_keyarr, 0, sizeof(latch_keyarr));
     memset(latch_rev_keyarr, 0, sizeof(latch_rev_keyarr));
     keyboard_shiftlock = 0;
@@ -328,6 +330,7 @@ static void keyboard_latch_matrix(CLOCK offset)
         memcpy(keyarr, latch_keyarr, sizeof(keyarr));
         memcpy(rev_keyarr, latch_rev_keyarr, sizeof(rev_keyarr));
     }
+    keyarr_serial++;
     if (keyboard_machine_func != NULL) {
         keyboard_machine_func(keyarr);
     }
@@ -1281,6 +1284,7 @@ int keyboard_snapshot_read_module(snapshot_t *s)
         snapshot_module_close(m);
         return -1;
     }
+    keyarr_serial++;
 
     return snapshot_module_close(m);
 }
@@ -148,4 +148,8 @@ extern void keyboard_alternative_set(int alternative);
 extern int keyarr[KBD_ROWS];
 extern int rev_keyarr[KBD_COLS];
 
+/* incremented whenever keyarr/rev_keyarr change, so machines can cache
+   data derived from the matrix */
+extern unsigned int keyarr_serial;
+
 #endif
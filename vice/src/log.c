@@ -45,6 +45,13 @@
 #include "string/stdstring.h"
 extern retro_log_printf_t log_cb;
 static char log_buf[1024]; /*create this here in case of tiny stack*/
+
+/* Messages below this level are dropped before they are formatted. The
+   compile time floor lets builds strip e.g. debug output entirely. */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL RETRO_LOG_DEBUG
+#endif
+static unsigned int log_level = LOG_MIN_LEVEL;
 #endif
 
 #ifdef DBGLOGGING
@@ -433,11 +440,11 @@ static int log_helper(unsigned int level, log_t log, const char *format, va_list
     signed int logi = (signed int)log;
     int rc;
 
-    if (!log_enabled) {
+    if (!log_enabled || level < LOG_MIN_LEVEL || level < log_level) {
         return 0;
     }
 
-    rc = vsprintf(log_buf, format, ap);
+    rc = vsnprintf(log_buf, sizeof(log_buf), format, ap);
 
     if (rc >= 0)
     {
@@ -531,6 +538,11 @@ int log_set_silent(int n)
     return 0;
 }
 
+void log_set_level(unsigned int level)
+{
+    log_level = (level < LOG_MIN_LEVEL) ? LOG_MIN_LEVEL : level;
+}
+
 /* stubs */
 int log_resources_init(void) {return 0;}
 void log_resources_shutdown(void) {}
@@ -48,6 +48,9 @@ extern void log_enable(int on);
 extern int log_set_silent(int n);
 extern int log_set_verbose(int n);
 extern int log_verbose_init(int argc, char **argv);
+#ifdef __LIBRETRO__
+extern void log_set_level(unsigned int level);
+#endif
 
 extern int log_message(log_t log, const char *format, ...) VICE_ATTR_PRINTF2;
 extern int log_warning(log_t log, const char *format, ...) VICE_ATTR_PRINTF2;
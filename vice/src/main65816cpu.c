@@ -275,6 +275,7 @@ void maincpu_mainloop(void)
     static uint8_t flag_n = 0;
     static uint8_t flag_z = 0;
     static uint8_t reg_emul = 1;
+    static uint8_t reg_width = P_65816_M | P_65816_X;
     static int interrupt65816 = IK_RESET;
 #ifndef NEED_REG_PC
     static unsigned int reg_pc;
@@ -348,6 +349,16 @@ if (!retro_mainloop)
 
 #define CALLER e_comp_space
 
+#ifdef HAVE_BINARY_MONITOR
+/* The binary monitor stopped the machine: leave before the instruction,
+   the next call continues with it once the machine is resumed.  */
+#define LEAVE_IF_MONITOR_STOPPED       \
+    if (monitor_binary_hold(CALLER)) { \
+        interrupt65816 |= IK_MONITOR;  \
+        return;                        \
+    }
+#endif
+
 #define ROM_TRAP_ALLOWED() mem_rom_trap_allowed((uint16_t)reg_pc)
 
 #define GLOBAL_REGS maincpu_regs
@@ -399,6 +410,7 @@ void maincpu_mainloop(void)
     uint8_t flag_n = 0;
     uint8_t flag_z = 0;
     uint8_t reg_emul = 1;
+    uint8_t reg_width = P_65816_M | P_65816_X;
     int interrupt65816 = IK_RESET;
 #ifndef NEED_REG_PC
     unsigned int reg_pc;
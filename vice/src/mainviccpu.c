@@ -538,6 +538,15 @@ if (!retro_mainloop)
 
 #define CALLER e_comp_space
 
+#ifdef HAVE_BINARY_MONITOR
+/* The binary monitor stopped the machine: leave before the instruction,
+   the next call continues with it once the machine is resumed.  */
+#define LEAVE_IF_MONITOR_STOPPED       \
+    if (monitor_binary_hold(CALLER)) { \
+        return;                        \
+    }
+#endif
+
 #define ROM_TRAP_ALLOWED() mem_rom_trap_allowed((uint16_t)reg_pc)
 
 #define GLOBAL_REGS maincpu_regs
@@ -196,6 +196,15 @@ extern void monitor_interface_destroy(monitor_interface_t *monitor_interface);
 extern int monitor_diskspace_dnr(int mem);
 extern int monitor_diskspace_mem(int dnr);
 
+#ifdef __LIBRETRO__
+/* Binary monitor protocol on a local socket, polled by the frontend.  */
+extern int monitor_binary_open(const char *path);
+extern void monitor_binary_close(void);
+extern void monitor_binary_poll(void);
+extern int monitor_binary_stopped(void);
+extern int monitor_binary_hold(MEMSPACE mem);
+#endif
+
 extern int mon_out(const char *format, ...) VICE_ATTR_PRINTF;
 
 /** Breakpoint interface.  */
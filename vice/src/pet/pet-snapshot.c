@@ -122,6 +122,8 @@ int pet_snapshot_read(const char *name, int event_mode)
         ef = -1;
     }
 
+    sound_snapshot_prepare();
+
     if (ef
         || maincpu_snapshot_read_module(s) < 0
         || cpu6809_snapshot_read_module(s) < 0
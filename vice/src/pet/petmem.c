@@ -133,6 +133,8 @@ static store_func_ptr_t _mem6809_write_tab[0x101];
 static read_func_ptr_t _mem6809_read_tab_watch[0x101];
 static store_func_ptr_t _mem6809_write_tab_watch[0x101];
 static uint8_t *_mem6809_read_base_tab[0x101];
+static uint8_t *_mem6809_read_base_tab_watch[0x101];
+static uint8_t **_mem6809_read_base_tab_ptr = _mem6809_read_base_tab;
 static int mem6809_read_limit_tab[0x101];
 
 read_func_ptr_t *_mem6809_read_tab_ptr;
@@ -710,6 +712,21 @@ uint8_t mem_read(uint16_t addr)
 #define PRINT_6809_STORE        0
 #define PRINT_6809_READ         0
 
+/*
+ * Pages that are plain RAM or ROM to the 6809 are read directly through
+ * the base table; everything else goes through the read functions.
+ */
+static inline uint8_t mem6809_read_byte(uint16_t addr)
+{
+    uint8_t *p = _mem6809_read_base_tab_ptr[addr >> 8];
+
+    if (p != NULL) {
+        last_access = p[addr & 0xff];
+        return last_access;
+    }
+    return _mem6809_read_tab_ptr[addr >> 8](addr);
+}
+
 void mem6809_store(uint16_t addr, uint8_t value)
 {
 #if PRINT_6809_STORE
@@ -724,11 +741,11 @@ uint8_t mem6809_read(uint16_t addr)
 {
 #if PRINT_6809_READ
     uint8_t v;
-    v = _mem6809_read_tab_ptr[addr >> 8](addr);
+    v = mem6809_read_byte(addr);
     printf("mem6809_read   %04x -> %02x\n", addr, v);
     return v;
 #else
-    return _mem6809_read_tab_ptr[addr >> 8](addr);
+    return mem6809_read_byte(addr);
 #endif
 }
 
@@ -746,9 +763,9 @@ void mem6809_store16(uint16_t addr, uint16_t value)
 uint16_t mem6809_read16(uint16_t addr)
 {
     uint16_t val;
-    val = _mem6809_read_tab_ptr[addr >> 8](addr) << 8;
+    val = mem6809_read_byte(addr) << 8;
     addr++;
-    val |= _mem6809_read_tab_ptr[addr >> 8](addr);
+    val |= mem6809_read_byte(addr);
 #if PRINT_6809_READ
     printf("mem6809_read16 %04x -> %04x\n", addr, val);
 #endif
@@ -774,13 +791,13 @@ void mem6809_store32(uint16_t addr, uint32_t value)
 uint32_t mem6809_read32(uint16_t addr)
 {
     uint32_t val;
-    val = _mem6809_read_tab_ptr[addr >> 8](addr) << 24;
+    val = mem6809_read_byte(addr) << 24;
     addr++;
-    val |= _mem6809_read_tab_ptr[addr >> 8](addr) << 16;
+    val |= mem6809_read_byte(addr) << 16;
     addr++;
-    val |= _mem6809_read_tab_ptr[addr >> 8](addr) << 8;
+    val |= mem6809_read_byte(addr) << 8;
     addr++;
-    val |= _mem6809_read_tab_ptr[addr >> 8](addr);
+    val |= mem6809_read_byte(addr);
 #if PRINT_6809_READ
     printf("mem6809_read32 %04x -> %04x\n", addr, val);
 #endif
@@ -1174,9 +1191,11 @@ void mem_toggle_watchpoints(int flag, void *context)
     if (flag) {
         _mem6809_read_tab_ptr = _mem6809_read_tab_watch;
         _mem6809_write_tab_ptr = _mem6809_write_tab_watch;
+        _mem6809_read_base_tab_ptr = _mem6809_read_base_tab_watch;
     } else {
         _mem6809_read_tab_ptr = _mem6809_read_tab;
         _mem6809_write_tab_ptr = _mem6809_write_tab;
+        _mem6809_read_base_tab_ptr = _mem6809_read_base_tab;
     }
 
     mem_update_tab_ptrs(flag);
@@ -1431,7 +1450,11 @@ static void mem_initialize_memory_6809_banked(void)
     for (i = 0x00; i < 0xa0; i++) {
         _mem6809_read_tab[i] = _mem_read_tab[i];
         _mem6809_write_tab[i] = _mem_write_tab[i];
-        _mem6809_read_base_tab[i] = _mem_read_base_tab[i];
+        if (_mem_read_tab[i] == ram_read) {
+            _mem6809_read_base_tab[i] = mem_ram + (i << 8);
+        } else {
+            _mem6809_read_base_tab[i] = _mem_read_base_tab[i];
+        }
         mem6809_read_limit_tab[i] = mem_read_limit_tab[i];
     }
     /*
@@ -1440,13 +1463,13 @@ static void mem_initialize_memory_6809_banked(void)
     for (i = 0xa0; i < 0xe8; i++) {
         _mem6809_read_tab[i] = rom6809_read;
         _mem6809_write_tab[i] = store_void;
-        _mem6809_read_base_tab[i] = mem_6809rom + i - (ROM6809_BASE >> 8);
+        _mem6809_read_base_tab[i] = mem_6809rom + (i << 8) - ROM6809_BASE;
         mem6809_read_limit_tab[i] = 0xe7fc;
     }
     for (i = 0xf0; i < 0x100; i++) {
         _mem6809_read_tab[i] = rom6809_read;
         _mem6809_write_tab[i] = store_void;
-        _mem6809_read_base_tab[i] = mem_6809rom + i - (ROM6809_BASE >> 8);
+        _mem6809_read_base_tab[i] = mem_6809rom + (i << 8) - ROM6809_BASE;
         mem6809_read_limit_tab[i] = 0xfffc;
     }
     /*
@@ -176,6 +176,8 @@ struct pet_sound_s {
 
     int first_sample_index;     /* where the consumer gets samples */
     int next_sample_index;      /* the producer is creating this sample */
+    int nonzero_samples;        /* finished samples in the ring that are
+                                   not silent */
 
     int clocks_per_sample;
     int fracs_per_sample;       /* fixed-point */
@@ -296,6 +298,13 @@ static sample_t pet_makesample(void)
         snd.first_sample_index++;
         snd.first_sample_index %= NSAMPLES;
 
+        if (sample != 0 && snd.nonzero_samples > 0) {
+            snd.nonzero_samples--;
+        }
+        if (snd.first_sample_index == snd.next_sample_index) {
+            snd.nonzero_samples = 0;
+        }
+
 #if HIGHPASS
         /* The highpass value is scaled with the same factor
          * as the sample. */
@@ -346,6 +355,31 @@ static int pet_sound_machine_calculate_samples(sound_t **psid, sample_t *pbuf, i
 
     create_intermediate_samples(maincpu_clk);
 
+#if LOWPASS_CB2 && !HIGHPASS
+    /*
+     * Most of the time the CB2 output is silent. Mixing in silent samples
+     * does not change the buffer, so just drop them from the ring.
+     * They are still counted out above, which keeps their timing
+     * relative to the next CB2 change.
+     */
+    if (snd.nonzero_samples == 0) {
+        int avail = (snd.next_sample_index - snd.first_sample_index + NSAMPLES)
+                    % NSAMPLES;
+
+        if (avail > 0 || snd.lowpass_prev == 0) {
+            if (avail > nr) {
+                avail = nr;
+            }
+            if (avail > 0) {
+                snd.first_sample_index += avail;
+                snd.first_sample_index %= NSAMPLES;
+                snd.lowpass_prev = 0;
+            }
+            return nr;
+        }
+    }
+#endif /* LOWPASS_CB2 && !HIGHPASS */
+
     for (i = 0; i < nr; i++) {
         v = pet_makesample();
 
@@ -380,8 +414,45 @@ void petsound_store_onoff(bool value)
     }
 }
 
+#if LOWPASS_CB2
+/*
+ * Equivalent to the loop in create_intermediate_samples() when CB2 is
+ * low and the filter has settled at 0: every sample up to rclk is then
+ * silent, so step over them all at once.
+ */
+static void create_silent_samples(CLOCK rclk)
+{
+    CLOCK step = ((CLOCK)snd.clocks_per_sample << FRAC_BITS) + snd.fracs_per_sample;
+    CLOCK start = (snd.end_of_sample_time << FRAC_BITS) + snd.end_of_sample_frac;
+    CLOCK n = (((rclk + 1) << FRAC_BITS) - start + step - 1) / step;
+    CLOCK last = start + (n - 1) * step;
+    int i;
+
+    /* Samples passed over become readable, so clear them */
+    for (i = 0; i < NSAMPLES && (CLOCK)i < n; i++) {
+        snd.next_sample_index++;
+        snd.next_sample_index %= NSAMPLES;
+        snd.samples[snd.next_sample_index] = 0;
+    }
+    snd.next_sample_index = (int)((snd.next_sample_index + (n - i)) % NSAMPLES);
+
+    snd.next_sample_time = last >> FRAC_BITS;
+    snd.latest_bit_time = snd.next_sample_time;
+    snd.end_of_sample_time = (last + step) >> FRAC_BITS;
+    snd.end_of_sample_frac = (int)((last + step) & FRAC_MASK);
+}
+#endif /* LOWPASS_CB2 */
+
 static void create_intermediate_samples(CLOCK rclk)
 {
+#if LOWPASS_CB2
+    if (!snd.manual && rclk >= snd.end_of_sample_time
+        && snd.samples[snd.next_sample_index] == 0) {
+        create_silent_samples(rclk);
+        return;
+    }
+#endif /* LOWPASS_CB2 */
+
     while (rclk >= snd.end_of_sample_time) {
 #if LOWPASS_CB2
         /*
@@ -412,6 +483,9 @@ static void create_intermediate_samples(CLOCK rclk)
             (snd.end_of_sample_time - snd.next_sample_time);
 #endif /* LOWPASS_CB2 */
 
+        if (snd.samples[snd.next_sample_index] != 0) {
+            snd.nonzero_samples++;
+        }
         snd.next_sample_index++;
         snd.next_sample_index %= NSAMPLES;
 #if LOWPASS_CB2
@@ -527,6 +601,7 @@ static void pet_sound_reset(sound_t *psid, CLOCK cpu_clk)
     DBG("### pet_sound_reset: cpu_clk %lu\n", cpu_clk);
     snd.first_sample_index = 0;
     snd.next_sample_index = 0;
+    snd.nonzero_samples = 0;
     snd.next_sample_time = cpu_clk;
     snd.end_of_sample_time = snd.next_sample_time + snd.clocks_per_sample;
 }
@@ -218,6 +218,7 @@ static int digiblaster_sound_machine_init(sound_t *psid, int speed, int cycles_p
 static void digiblaster_sound_machine_store(sound_t *psid, uint16_t addr, uint8_t val)
 {
     snd.voice0 = val;
+    sound_dac_store(&digiblaster_dac, (int)val * 128);
 }
 
 static void digiblaster_sound_reset(sound_t *psid, CLOCK cpu_clk)
@@ -73,7 +73,8 @@ static sound_chip_t ted_sound_chip = {
     ted_sound_reset,                     /* sound chip reset function */
     ted_sound_machine_cycle_based,       /* sound chip 'is_cycle_based()' function, chip is NOT cycle based */
     ted_sound_machine_channels,          /* sound chip 'get_amount_of_channels()' function, sound chip has 1 channel */
-    1                                    /* sound chip enabled flag, chip is always enabled */
+    1,                                   /* sound chip enabled flag, chip is always enabled */
+    1                                    /* sound chip writes are queued until the sound is run */
 };
 
 static uint16_t ted_sound_chip_offset = 0;
@@ -173,101 +174,149 @@ static const int16_t volume_tab[16] = {
     0x3fff, 0x3fff, 0x3fff, 0x3fff, 0x3fff, 0x3fff, 0x3fff, 0x3fff
 };
 
-static int ted_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, int soc, int scc, CLOCK *delta_t)
+#define TED_NOISE_STEP(r)                       \
+    (uint8_t)(((r) << 1) +                      \
+              (1 ^ (((r) >> 7) & 1) ^           \
+               (((r) >> 5) & 1) ^               \
+               (((r) >> 4) & 1) ^               \
+               (((r) >> 1) & 1)))
+
+/* Advance the voices by 'ticks' (8 cycle units). Only called when at least
+   one of the voice accumulators runs out within those ticks.  */
+static void ted_sound_advance_voices(uint32_t ticks)
 {
-    int i;
     int j;
-    int16_t volume;
 
-    if (snd.digital) {
-        for (i = 0; i < nr; i++) {
-            pbuf[i * soc] = sound_audio_mix(pbuf[i * soc], (snd.volume * (snd.voice0_output_enabled + snd.voice1_output_enabled)));
-            if (soc > 1) {
-                pbuf[(i * soc) + 1] = sound_audio_mix(pbuf[(i * soc) + 1], (snd.volume * (snd.voice0_output_enabled + snd.voice1_output_enabled)));
+    if (snd.voice0_accu <= ticks) {
+        uint32_t delay = ticks - snd.voice0_accu;
+        snd.voice0_sign ^= 1;
+        snd.voice0_accu = 1023 - snd.voice0_reload;
+        if (snd.voice0_accu == 0) {
+            snd.voice0_accu = 1024;
+        }
+        if (delay >= snd.voice0_accu) {
+            snd.voice0_sign = ((delay / snd.voice0_accu)
+                               & 1) ? snd.voice0_sign ^ 1
+                              : snd.voice0_sign;
+            snd.voice0_accu = snd.voice0_accu - (delay % snd.voice0_accu);
+        } else {
+            snd.voice0_accu -= delay;
+        }
+    } else {
+        snd.voice0_accu -= ticks;
+    }
+
+    if (snd.voice1_accu <= ticks) {
+        uint32_t delay = ticks - snd.voice1_accu;
+        snd.voice1_sign ^= 1;
+        snd.noise_shift_register = TED_NOISE_STEP(snd.noise_shift_register);
+        snd.voice1_accu = 1023 - snd.voice1_reload;
+        if (snd.voice1_accu == 0) {
+            snd.voice1_accu = 1024;
+        }
+        if (delay >= snd.voice1_accu) {
+            snd.voice1_sign = ((delay / snd.voice1_accu)
+                               & 1) ? snd.voice1_sign ^ 1
+                              : snd.voice1_sign;
+            for (j = 0; j < (int)(delay / snd.voice1_accu);
+                 j++) {
+                snd.noise_shift_register = TED_NOISE_STEP(snd.noise_shift_register);
             }
+            snd.voice1_accu = snd.voice1_accu - (delay % snd.voice1_accu);
+        } else {
+            snd.voice1_accu -= delay;
+        }
+    } else {
+        snd.voice1_accu -= ticks;
+    }
+}
+
+/* Current output level of the voices.  */
+static int16_t ted_sound_volume(void)
+{
+    int16_t volume = 0;
+
+    if (snd.voice0_output_enabled && snd.voice0_sign) {
+        volume += snd.volume;
+    }
+    if (snd.voice1_output_enabled && !snd.noise && snd.voice1_sign) {
+        volume += snd.volume;
+    }
+    if (snd.voice1_output_enabled && snd.noise && (!(snd.noise_shift_register & 1))) {
+        volume += snd.volume;
+    }
+    return volume;
+}
+
+/* Mix a run of 'n' samples of constant level into the buffer.  */
+static void ted_sound_mix_run(int16_t *pbuf, int n, int soc, int16_t volume)
+{
+    int i;
+
+    /* mixing in silence does not change the buffer */
+    if (volume == 0) {
+        return;
+    }
+
+    if (soc > 1) {
+        for (i = 0; i < n; i++) {
+            pbuf[i * soc] = sound_audio_mix(pbuf[i * soc], volume);
+            pbuf[(i * soc) + 1] = sound_audio_mix(pbuf[(i * soc) + 1], volume);
         }
     } else {
-        for (i = 0; i < nr; i++) {
+        for (i = 0; i < n; i++) {
+            pbuf[i] = sound_audio_mix(pbuf[i], volume);
+        }
+    }
+}
+
+/* The output only changes when one of the voice accumulators runs out, so
+   the samples are rendered in runs of constant level between those
+   edges.  */
+static int ted_sound_machine_calculate_samples(sound_t **psid, int16_t *pbuf, int nr, int soc, int scc, CLOCK *delta_t)
+{
+    int i, run;
+    int16_t volume;
+    uint32_t ticks, elapsed, limit;
+
+    if (snd.digital) {
+        ted_sound_mix_run(pbuf, nr, soc, (int16_t)(snd.volume * (snd.voice0_output_enabled + snd.voice1_output_enabled)));
+        return nr;
+    }
+
+    volume = ted_sound_volume();
+
+    for (i = 0; i < nr; i = run + 1) {
+        /* no edge as long as fewer ticks than this have elapsed */
+        limit = (snd.voice0_accu < snd.voice1_accu) ? snd.voice0_accu : snd.voice1_accu;
+        elapsed = 0;
+        ticks = 0;
+
+        for (run = i; run < nr; run++) {
             snd.sample_position_remainder += snd.sample_length_remainder;
             if (snd.sample_position_remainder >= snd.speed) {
                 snd.sample_position_remainder -= snd.speed;
                 snd.sample_position_integer++;
             }
             snd.sample_position_integer += snd.sample_length_integer;
-            if (snd.sample_position_integer >= 8) {
-                /* Advance state engine */
-                uint32_t ticks = snd.sample_position_integer >> 3;
-                if (snd.voice0_accu <= ticks) {
-                    uint32_t delay = ticks - snd.voice0_accu;
-                    snd.voice0_sign ^= 1;
-                    snd.voice0_accu = 1023 - snd.voice0_reload;
-                    if (snd.voice0_accu == 0) {
-                        snd.voice0_accu = 1024;
-                    }
-                    if (delay >= snd.voice0_accu) {
-                        snd.voice0_sign = ((delay / snd.voice0_accu)
-                                           & 1) ? snd.voice0_sign ^ 1
-                                          : snd.voice0_sign;
-                        snd.voice0_accu = snd.voice0_accu - (delay % snd.voice0_accu);
-                    } else {
-                        snd.voice0_accu -= delay;
-                    }
-                } else {
-                    snd.voice0_accu -= ticks;
-                }
-
-                if (snd.voice1_accu <= ticks) {
-                    uint32_t delay = ticks - snd.voice1_accu;
-                    snd.voice1_sign ^= 1;
-                    snd.noise_shift_register
-                        = (snd.noise_shift_register << 1) +
-                          ( 1 ^ ((snd.noise_shift_register >> 7) & 1) ^
-                            ((snd.noise_shift_register >> 5) & 1) ^
-                            ((snd.noise_shift_register >> 4) & 1) ^
-                            ((snd.noise_shift_register >> 1) & 1));
-                    snd.voice1_accu = 1023 - snd.voice1_reload;
-                    if (snd.voice1_accu == 0) {
-                        snd.voice1_accu = 1024;
-                    }
-                    if (delay >= snd.voice1_accu) {
-                        snd.voice1_sign = ((delay / snd.voice1_accu)
-                                           & 1) ? snd.voice1_sign ^ 1
-                                          : snd.voice1_sign;
-                        for (j = 0; j < (int)(delay / snd.voice1_accu);
-                             j++) {
-                            snd.noise_shift_register
-                                = (snd.noise_shift_register << 1) +
-                                  ( 1 ^ ((snd.noise_shift_register >> 7) & 1) ^
-                                    ((snd.noise_shift_register >> 5) & 1) ^
-                                    ((snd.noise_shift_register >> 4) & 1) ^
-                                    ((snd.noise_shift_register >> 1) & 1));
-                        }
-                        snd.voice1_accu = snd.voice1_accu - (delay % snd.voice1_accu);
-                    } else {
-                        snd.voice1_accu -= delay;
-                    }
-                } else {
-                    snd.voice1_accu -= ticks;
-                }
-            }
-            snd.sample_position_integer = snd.sample_position_integer & 7;
-
-            volume = 0;
+            ticks = snd.sample_position_integer >> 3;
+            snd.sample_position_integer &= 7;
 
-            if (snd.voice0_output_enabled && snd.voice0_sign) {
-                volume += snd.volume;
-            }
-            if (snd.voice1_output_enabled && !snd.noise && snd.voice1_sign) {
-                volume += snd.volume;
-            }
-            if (snd.voice1_output_enabled && snd.noise && (!(snd.noise_shift_register & 1))) {
-                volume += snd.volume;
+            if (ticks && elapsed + ticks >= limit) {
+                break;
             }
+            elapsed += ticks;
+        }
 
-            pbuf[i * soc] = sound_audio_mix(pbuf[i * soc], volume);
-            if (soc > 1) {
-                pbuf[(i * soc) + 1] = sound_audio_mix(pbuf[(i * soc) + 1], volume);
-            }
+        snd.voice0_accu -= elapsed;
+        snd.voice1_accu -= elapsed;
+        ted_sound_mix_run(pbuf + (i * soc), run - i, soc, volume);
+
+        if (run < nr) {
+            /* sample 'run' has an edge */
+            ted_sound_advance_voices(ticks);
+            volume = ted_sound_volume();
+            ted_sound_mix_run(pbuf + (run * soc), 1, soc, volume);
         }
     }
     return nr;
@@ -140,11 +140,7 @@ static const resource_string_t resources_string[] = {
       (char **)&driver_select[0].drv_name, set_printer_driver, (void *)0 },
     { "Printer5Driver", "ascii", RES_EVENT_NO, NULL,
       (char **)&driver_select[1].drv_name, set_printer_driver, (void *)1 },
-#ifdef __LIBRETRO__
-    { "Printer6Driver", "raw", RES_EVENT_NO, NULL,
-#else
     { "Printer6Driver", "1520", RES_EVENT_NO, NULL,
-#endif
       (char **)&driver_select[2].drv_name, set_printer_driver, (void *)2 },
     RESOURCE_STRING_LIST_END
 };
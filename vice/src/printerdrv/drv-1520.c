@@ -144,12 +144,24 @@ static void write_lines(plot_t *mps, int lines)
 
     lines *= PIXELS_PER_STEP;
 
+#ifdef __LIBRETRO__
+    for (y = 0; y < lines; y++) {
+        uint8_t row[X_PIXELS];
+
+        for (x = 0; x < X_PIXELS; x++) {
+            row[x] = tochar[(*mps->sheet)[y][x]];
+        }
+        output_select_putspan(prnr, row, X_PIXELS);
+        output_select_putc(prnr, (uint8_t)OUTPUT_NEWLINE);
+    }
+#else
     for (y = 0; y < lines; y++) {
         for (x = 0; x < X_PIXELS; x++) {
             output_select_putc(prnr, tochar[(*mps->sheet)[y][x]]);
         }
         output_select_putc(prnr, (uint8_t)OUTPUT_NEWLINE);
     }
+#endif
 }
 
 /*
@@ -182,6 +182,17 @@ static void print_cbm_char(mps_t *mps, const uint8_t rawchar)
 static void write_line(mps_t *mps, unsigned int prnr)
 {
     int x, y;
+#ifdef __LIBRETRO__
+    uint8_t row[480];
+
+    for (y = 0; y < 7; y++) {
+        for (x = 0; x < 480; x++) {
+            row[x] = (uint8_t)(mps->line[x][y] ? OUTPUT_PIXEL_BLACK : OUTPUT_PIXEL_WHITE);
+        }
+        output_select_putspan(prnr, row, 480);
+        output_select_putc(prnr, (uint8_t)(OUTPUT_NEWLINE));
+    }
+#else
 
     for (y = 0; y < 7; y++) {
         for (x = 0; x < 480; x++) {
@@ -190,6 +201,7 @@ static void write_line(mps_t *mps, unsigned int prnr)
         }
         output_select_putc(prnr, (uint8_t)(OUTPUT_NEWLINE));
     }
+#endif
 
     if (!is_mode(mps, MPS_BITMODE)) {
         /* bitmode:  9 rows/inch (7lines/row * 9rows/inch=63 lines/inch) */
@@ -339,6 +339,19 @@ static inline int inc_y(nl10_t *nl10)
 }
 
 
+#ifdef __LIBRETRO__
+static void output_row(const uint8_t *line, unsigned int prnr)
+{
+    uint8_t row[MAX_COL];
+    int c;
+
+    for (c = 0; c < MAX_COL; c++) {
+        row[c] = (uint8_t)(line[c] ? OUTPUT_PIXEL_BLACK : OUTPUT_PIXEL_WHITE);
+    }
+    output_select_putspan(prnr, row, MAX_COL);
+}
+#endif
+
 static void linefeed(nl10_t *nl10, unsigned int prnr)
 {
     int c, i, j;
@@ -351,9 +364,13 @@ static void linefeed(nl10_t *nl10, unsigned int prnr)
             }
 
             /* output topmost row */
+#ifdef __LIBRETRO__
+            output_row(nl10->line[0], prnr);
+#else
             for (c = 0; c < MAX_COL; c++) {
                 output_select_putc(prnr, (uint8_t)(nl10->line[0][c] ? OUTPUT_PIXEL_BLACK : OUTPUT_PIXEL_WHITE));
             }
+#endif
             output_select_putc(prnr, (uint8_t)(OUTPUT_NEWLINE));
 
             /* move everything else one row up */
@@ -387,9 +404,13 @@ static void output_buf(nl10_t *nl10, unsigned int prnr)
 
     /* output buffer */
     for (r = 0; r < BUF_ROW; r++) {
+#ifdef __LIBRETRO__
+        output_row(drv_nl10[prnr].line[r], prnr);
+#else
         for (c = 0; c < MAX_COL; c++) {
             output_select_putc(prnr, (uint8_t)(drv_nl10[prnr].line[r][c] ? OUTPUT_PIXEL_BLACK : OUTPUT_PIXEL_WHITE));
         }
+#endif
         output_select_putc(prnr, (uint8_t)(OUTPUT_NEWLINE));
     }
 
@@ -422,21 +443,19 @@ inline static void draw_point2(nl10_t *nl10, int x, int y)
    **
 */
 
-    nl10->line[y][x] = 1;
-    if (x < MAX_COL - 1) {
-        nl10->line[y][x + 1] = 1;
-    }
-    if (y < BUF_ROW - 1) {
-        nl10->line[y + 1][x] = 1;
-    }
-    if (y > 0) {
-        nl10->line[y - 1][x] = 1;
-    }
-    if ((y < BUF_ROW - 1) && (x < MAX_COL - 1)) {
-        nl10->line[y + 1][x + 1] = 1;
+    int row;
+
+    if ((x < 0) || (x >= MAX_COL)) {
+        return;
     }
-    if ((y > 0) && (x < MAX_COL - 1)) {
-        nl10->line[y - 1][x + 1] = 1;
+    for (row = y - 1; row <= y + 1; row++) {
+        if ((row < 0) || (row >= BUF_ROW)) {
+            continue;
+        }
+        nl10->line[row][x] = 1;
+        if (x < MAX_COL - 1) {
+            nl10->line[row][x + 1] = 1;
+        }
     }
 }
 
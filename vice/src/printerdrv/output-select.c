@@ -261,3 +261,21 @@ int output_select_formfeed(unsigned int prnr)
 {
     return output_select[prnr].output_formfeed(prnr);
 }
+
+#ifdef __LIBRETRO__
+/* Output a run of pixels, same as putc() for each of them.  */
+int output_select_putspan(unsigned int prnr, const uint8_t *pixels, unsigned int count)
+{
+    unsigned int i;
+
+    if (output_select[prnr].output_putspan) {
+        return output_select[prnr].output_putspan(prnr, pixels, count);
+    }
+
+    for (i = 0; i < count; i++) {
+        output_select[prnr].output_putc(prnr, pixels[i]);
+    }
+
+    return 0;
+}
+#endif
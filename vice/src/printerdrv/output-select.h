@@ -39,6 +39,9 @@ struct output_select_s {
     int (*output_getc)(unsigned int prnr, uint8_t *b);
     int (*output_flush)(unsigned int prnr);
     int (*output_formfeed)(unsigned int prnr);
+#ifdef __LIBRETRO__
+    int (*output_putspan)(unsigned int prnr, const uint8_t *pixels, unsigned int count);
+#endif
 };
 typedef struct output_select_s output_select_t;
 
@@ -59,6 +62,9 @@ extern int output_select_putc(unsigned int prnr, uint8_t b);
 extern int output_select_getc(unsigned int prnr, uint8_t *b);
 extern int output_select_flush(unsigned int prnr);
 extern int output_select_formfeed(unsigned int prnr);
+#ifdef __LIBRETRO__
+extern int output_select_putspan(unsigned int prnr, const uint8_t *pixels, unsigned int count);
+#endif
 extern void output_select_writeline(unsigned int prnr);
 
 #endif
@@ -276,6 +276,9 @@ int output_text_init_resources(void)
     output_select.output_getc = output_text_getc;
     output_select.output_flush = output_text_flush;
     output_select.output_formfeed = output_text_formfeed;
+#ifdef __LIBRETRO__
+    output_select.output_putspan = NULL;
+#endif
 
     output_select_register(&output_select);
 
@@ -58,12 +58,16 @@ SID::SID()
   // Initialize pointers.
   sample = 0;
   fir = 0;
+  fir_sum = 0;
   fir_N = 0;
   fir_RES = 0;
   fir_beta = 0;
   fir_f_cycles_per_sample = 0;
   fir_filter_scale = 0;
 
+  settled_voice[0] = settled_voice[1] = settled_voice[2] = 0;
+  settled_mask = 0;
+
   sid_model = MOS6581;
   voice[0].set_sync_source(&voice[2]);
   voice[1].set_sync_source(&voice[0]);
@@ -88,6 +92,7 @@ SID::~SID()
 {
   delete[] sample;
   delete[] fir;
+  delete[] fir_sum;
 }
 
 
@@ -115,6 +120,7 @@ void SID::set_chip_model(chip_model model)
   }
 
   filter.set_chip_model(model);
+  settled_mask = 0;
 }
 
 
@@ -128,6 +134,7 @@ void SID::reset()
   }
   filter.reset();
   extfilt.reset();
+  settled_mask = 0;
 
   bus_value = 0;
   bus_value_ttl = 0;
@@ -143,6 +150,7 @@ void SID::input(short sample)
 {
   // The input can be used to simulate the MOS8580 "digi boost" hardware hack.
   filter.input(sample);
+  settled_mask = 0;
 }
 
 
@@ -215,6 +223,9 @@ void SID::write(reg8 offset, reg8 value)
 // ----------------------------------------------------------------------------
 void SID::write()
 {
+  // Any register may change the filter parameters.
+  settled_mask = 0;
+
   switch (write_address) {
   case 0x00:
     voice[0].wave.writeFREQ_LO(bus_value);
@@ -445,6 +456,8 @@ void SID::write_state(const State& state)
     voice[i].envelope.hold_zero = state.hold_zero[i];
     voice[i].envelope.envelope_pipeline = state.envelope_pipeline[i];
   }
+
+  settled_mask = 0;
 }
 
 
@@ -456,6 +469,7 @@ void SID::write_state(const State& state)
 void SID::set_voice_mask(reg4 mask)
 {
   filter.set_voice_mask(mask);
+  settled_mask = 0;
 }
 
 
@@ -465,6 +479,7 @@ void SID::set_voice_mask(reg4 mask)
 void SID::enable_filter(bool enable)
 {
   filter.enable_filter(enable);
+  settled_mask = 0;
 }
 
 
@@ -476,6 +491,7 @@ void SID::enable_filter(bool enable)
 // ----------------------------------------------------------------------------
 void SID::adjust_filter_bias(double dac_bias) {
   filter.adjust_filter_bias(dac_bias);
+  settled_mask = 0;
 }
 
 
@@ -485,6 +501,7 @@ void SID::adjust_filter_bias(double dac_bias) {
 void SID::enable_external_filter(bool enable)
 {
   extfilt.enable_filter(enable);
+  settled_mask = 0;
 }
 
 // ----------------------------------------------------------------------------
@@ -618,8 +635,10 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
   {
     delete[] sample;
     delete[] fir;
+    delete[] fir_sum;
     sample = 0;
     fir = 0;
+    fir_sum = 0;
     return true;
   }
 
@@ -632,6 +651,8 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
     sample[j] = 0;
   }
   sample_index = 0;
+  sample_last = 0;
+  sample_run = 0;
 
   const double pi = 3.1415926535897932385;
 
@@ -684,7 +705,9 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
 
   // Allocate memory for FIR tables.
   delete[] fir;
+  delete[] fir_sum;
   fir = new short[fir_N*fir_RES];
+  fir_sum = new int[fir_RES];
 
   // Calculate fir_RES FIR tables for linear interpolation.
   for (int i = 0; i < fir_RES; i++) {
@@ -703,6 +726,15 @@ bool SID::set_sampling_parameters(double clock_freq, sampling_method method,
     }
   }
 
+  // Sum FIR tables, for convolution with a constant signal.
+  for (int i = 0; i < fir_RES; i++) {
+    int v = 0;
+    for (int j = 0; j < fir_N; j++) {
+      v += fir[i*fir_N + j];
+    }
+    fir_sum[i] = v;
+  }
+
   return true;
 }
 
@@ -811,11 +843,8 @@ void SID::clock(cycle_count delta_t)
     voice[i].wave.set_waveform_output(delta_t);
   }
 
-  // Clock filter.
-  filter.clock(delta_t, voice[0].output(), voice[1].output(), voice[2].output());
-
-  // Clock external filter.
-  extfilt.clock(delta_t, filter.output());
+  // Clock filter and external filter.
+  clock_filters(delta_t);
 }
 
 
@@ -973,8 +1002,16 @@ int SID::clock_resample(cycle_count& delta_t, short* buf, int n, int interleave)
 
     for (int i = 0; i < delta_t_sample; i++) {
       clock();
-      sample[sample_index] = sample[sample_index + RINGSIZE] = clip(output());
+      short s_out = clip(output());
+      sample[sample_index] = sample[sample_index + RINGSIZE] = s_out;
       ++sample_index &= RINGMASK;
+      if (likely(s_out != sample_last)) {
+        sample_last = s_out;
+        sample_run = 1;
+      }
+      else if (sample_run < RINGSIZE) {
+        ++sample_run;
+      }
     }
 
     if ((delta_t -= delta_t_sample) == 0) {
@@ -986,6 +1023,20 @@ int SID::clock_resample(cycle_count& delta_t, short* buf, int n, int interleave)
 
     int fir_offset = sample_offset*fir_RES >> FIXP_SHIFT;
     int fir_offset_rmd = sample_offset*fir_RES & FIXP_MASK;
+
+    // Both convolutions span the last fir_N + 1 samples; if these are
+    // equal (e.g. silence), each reduces to a multiplication.
+    if (sample_run > fir_N) {
+      int v1 = sample_last*fir_sum[fir_offset];
+      int v2 = sample_last*fir_sum[fir_offset + 1 == fir_RES ? 0 : fir_offset + 1];
+      int v = v1 + int((unsigned(fir_offset_rmd)*unsigned(v2 - v1)) >> FIXP_SHIFT);
+
+      v >>= FIR_SHIFT;
+
+      buf[s*interleave] = clip(v);
+      continue;
+    }
+
     short* fir_start = fir + fir_offset*fir_N;
     short* sample_start = sample + sample_index - fir_N - 1 + RINGSIZE;
 
@@ -1040,8 +1091,16 @@ int SID::clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int int
 
     for (int i = 0; i < delta_t_sample; i++) {
       clock();
-      sample[sample_index] = sample[sample_index + RINGSIZE] = output();
+      short s_out = output();
+      sample[sample_index] = sample[sample_index + RINGSIZE] = s_out;
       ++sample_index &= RINGMASK;
+      if (likely(s_out != sample_last)) {
+        sample_last = s_out;
+        sample_run = 1;
+      }
+      else if (sample_run < RINGSIZE) {
+        ++sample_run;
+      }
     }
 
     if ((delta_t -= delta_t_sample) == 0) {
@@ -1052,6 +1111,17 @@ int SID::clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int int
     sample_offset = next_sample_offset & FIXP_MASK;
 
     int fir_offset = sample_offset*fir_RES >> FIXP_SHIFT;
+
+    // Convolution with a run of equal samples (e.g. silence).
+    if (sample_run >= fir_N) {
+      int v = sample_last*fir_sum[fir_offset];
+
+      v >>= FIR_SHIFT;
+
+      buf[s*interleave] = clip(v);
+      continue;
+    }
+
     short* fir_start = fir + fir_offset*fir_N;
     short* sample_start = sample + sample_index - fir_N + RINGSIZE;
 
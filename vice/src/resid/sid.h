@@ -109,6 +109,8 @@ public:
   int clock_interpolate(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_resample(cycle_count& delta_t, short* buf, int n, int interleave);
   int clock_resample_fastmem(cycle_count& delta_t, short* buf, int n, int interleave);
+  void clock_filters(cycle_count delta_t);
+  void clock_filters(cycle_count delta_t, int voice1, int voice2, int voice3);
   void write();
 
   chip_model sid_model;
@@ -169,6 +171,23 @@ public:
   // FIR_RES filter tables (FIR_N*FIR_RES).
   short* fir;
 
+  // Sum of the coefficients of each FIR table (FIR_RES), and the run length
+  // of the most recent value in the sample ring buffer. A convolution over
+  // a run of equal samples reduces to a single multiplication.
+  int* fir_sum;
+  short sample_last;
+  int sample_run;
+
+  // Fixed point detection for the filter stages.
+  // When the voice outputs stop changing (e.g. silence, or a held DC level)
+  // the filter and the external filter converge to a state which further
+  // clocking leaves unchanged. Bit n of settled_mask is set when a clock
+  // step of n cycles (bit 0: a single cycle step) has been observed not to
+  // change the state for the inputs in settled_voice; such steps are then
+  // skipped until an input or a filter parameter changes.
+  int settled_voice[3];
+  unsigned int settled_mask;
+
   bool raw_debug_output; // FIXME: should be private?
 };
 
@@ -219,11 +238,8 @@ void SID::clock()
     voice[i].wave.set_waveform_output();
   }
 
-  // Clock filter.
-  filter.clock(voice[0].output(), voice[1].output(), voice[2].output());
-
-  // Clock external filter.
-  extfilt.clock(filter.output());
+  // Clock filter and external filter.
+  clock_filters(0);
 
   // Pipelined writes on the MOS8580.
   if (unlikely(write_pipeline)) {
@@ -240,6 +256,71 @@ void SID::clock()
   }
 }
 
+
+// ----------------------------------------------------------------------------
+// Clock filter and external filter.
+// ----------------------------------------------------------------------------
+RESID_INLINE
+void SID::clock_filters(cycle_count delta_t, int voice1, int voice2, int voice3)
+{
+  if (delta_t) {
+    filter.clock(delta_t, voice1, voice2, voice3);
+    extfilt.clock(delta_t, filter.output());
+  }
+  else {
+    filter.clock(voice1, voice2, voice3);
+    extfilt.clock(filter.output());
+  }
+}
+
+
+// ----------------------------------------------------------------------------
+// Clock filter and external filter, skipping the step if they have settled.
+// delta_t is the number of cycles to clock, or 0 for a single cycle step.
+// ----------------------------------------------------------------------------
+RESID_INLINE
+void SID::clock_filters(cycle_count delta_t)
+{
+  int voice1 = voice[0].output();
+  int voice2 = voice[1].output();
+  int voice3 = voice[2].output();
+  unsigned int step = delta_t < 32 ? 1u << delta_t : 0;
+
+  if (likely(voice1 != settled_voice[0] || voice2 != settled_voice[1] ||
+             voice3 != settled_voice[2]))
+  {
+    settled_voice[0] = voice1;
+    settled_voice[1] = voice2;
+    settled_voice[2] = voice3;
+    settled_mask = 0;
+    step = 0;
+  }
+  else if (settled_mask & step) {
+    return;
+  }
+
+  if (likely(!step)) {
+    clock_filters(delta_t, voice1, voice2, voice3);
+    return;
+  }
+
+  // Same inputs as in the previous step; check for a fixed point.
+  int Vhp = filter.Vhp, Vbp = filter.Vbp, Vlp = filter.Vlp;
+  int Vbp_x = filter.Vbp_x, Vbp_vc = filter.Vbp_vc;
+  int Vlp_x = filter.Vlp_x, Vlp_vc = filter.Vlp_vc;
+  int ext_Vlp = extfilt.Vlp, ext_Vhp = extfilt.Vhp;
+
+  clock_filters(delta_t, voice1, voice2, voice3);
+
+  if (Vhp == filter.Vhp && Vbp == filter.Vbp && Vlp == filter.Vlp &&
+      Vbp_x == filter.Vbp_x && Vbp_vc == filter.Vbp_vc &&
+      Vlp_x == filter.Vlp_x && Vlp_vc == filter.Vlp_vc &&
+      ext_Vlp == extfilt.Vlp && ext_Vhp == extfilt.Vhp)
+  {
+    settled_mask |= step;
+  }
+}
+
 #endif // RESID_INLINING || defined(RESID_SID_CC)
 
 } // namespace reSID
@@ -136,6 +136,14 @@ static unsigned int sound_frames_per_sec;
 static unsigned int sound_cycles_per_frame;
 static unsigned int sound_samples_per_frame;
 
+#ifdef __LIBRETRO__
+/* Sample position per cycle in 32.32 fixed point, and the length of one pass
+   through the sample in cycles, worked out once when sampling starts.  */
+static uint64_t sound_sample_step;
+static CLOCK sound_sample_loop_cycles;
+static CLOCK sound_sample_start_clk;
+#endif
+
 static int current_channels = 0;
 
 static uint8_t *file_buffer = NULL;
@@ -2092,6 +2100,10 @@ static int handle_file_type(int channels)
 
 /* ---------------------------------------------------------------------- */
 
+#ifdef __LIBRETRO__
+static void file_free_sample(void);
+#endif
+
 static void file_load_sample(int channels)
 {
     FILE *sample_file = NULL;
@@ -2099,6 +2111,13 @@ static void file_load_sample(int channels)
 
     current_channels = channels;
 
+#ifdef __LIBRETRO__
+    /* Opening the sampler reloads the file, don't leak the previous one */
+    if (sample_buffer1) {
+        file_free_sample();
+    }
+#endif
+
     if (sample_name != NULL && *sample_name != '\0') {
         sample_file = fopen(sample_name, "rb");
         if (sample_file) {
@@ -2206,6 +2225,36 @@ static int sampler_file_cmdline_options_init(void)
 /* ---------------------------------------------------------------------- */
 
 /* For now channel is ignored */
+#ifdef __LIBRETRO__
+/* Samplers are read from CPU I/O accesses, so keep this to an index lookup
+   instead of walking the frames that passed since the previous read.  */
+static uint8_t file_get_sample(int channel)
+{
+    CLOCK cycles;
+
+    if (!sample_buffer1) {
+        return 0x80;
+    }
+    if (!sound_sampling_started) {
+        sound_sampling_started = 1;
+        sound_sample_step = ((uint64_t)sound_audio_rate << 32) / (uint64_t)machine_get_cycles_per_second();
+        sound_sample_loop_cycles = sound_sample_step ? ((uint64_t)sample_size << 32) / sound_sample_step : 1;
+        if (!sound_sample_loop_cycles) {
+            sound_sample_loop_cycles = 1;
+        }
+        sound_sample_start_clk = maincpu_clk;
+        return sample_buffer1[0];
+    }
+
+    cycles = maincpu_clk - sound_sample_start_clk;
+    if (cycles >= sound_sample_loop_cycles) {
+        sound_sample_start_clk += cycles - (cycles % sound_sample_loop_cycles);
+        cycles %= sound_sample_loop_cycles;
+    }
+
+    return sample_buffer1[(unsigned int)((cycles * sound_sample_step) >> 32) % sample_size];
+}
+#else
 static uint8_t file_get_sample(int channel)
 {
     CLOCK current_frame = 0;
@@ -2239,6 +2288,7 @@ static uint8_t file_get_sample(int channel)
 
     return sample_buffer1[(frame_sample + sound_sample_frame_start) % sample_size];
 }
+#endif
 
 static void file_shutdown(void)
 {
@@ -675,19 +675,24 @@ inline static void setup_voice(voice_t *pv)
     pv->gateflip = 0;
 }
 
+/* registers only change between calls, so this is needed once per call */
+inline static void setup_all(sound_t *psid)
+{
+    setup_sid(psid);
+    setup_voice(&psid->v[0]);
+    setup_voice(&psid->v[1]);
+    setup_voice(&psid->v[2]);
+}
+
 static int16_t fastsid_calculate_single_sample(sound_t *psid, int i)
 {
     uint32_t o0, o1, o2;
     int dosync1, dosync2;
     voice_t *v0, *v1, *v2;
 
-    setup_sid(psid);
     v0 = &psid->v[0];
-    setup_voice(v0);
     v1 = &psid->v[1];
-    setup_voice(v1);
     v2 = &psid->v[2];
-    setup_voice(v2);
 
     /* addfptrs, noise & hard sync test */
     dosync1 = 0;
@@ -765,22 +770,107 @@ static int16_t fastsid_calculate_single_sample(sound_t *psid, int i)
     return (int16_t)(((int32_t)((o0 + o1 + o2) >> 20) - 0x600) * psid->vol);
 }
 
+#ifdef WAVETABLES
+#define SPANSIZE 256
+
+/* Without hard sync or ring modulation the voices don't depend on each
+   other within a sample, so each one can be rendered on its own. */
+static int voices_independent(sound_t *psid)
+{
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        if (psid->v[i].sync || psid->v[i].wtr[0] != psid->v[i].wtr[1]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Render n samples of one voice, adding them to o[]. Does the same steps
+   as fastsid_calculate_single_sample() in the same order. */
+static void render_voice_span(sound_t *psid, voice_t *pv, uint32_t *o, int n,
+                              int audible)
+{
+    int i, held;
+    uint32_t v;
+
+    /* sustain and idle don't step the counter, and it can't trigger a
+       state change either, so the envelope holds for the whole span */
+    held = (pv->adsrs == 0)
+           && (pv->adsr + 0x80000000 >= pv->adsrz + 0x80000000);
+
+    for (i = 0; i < n; i++) {
+        if ((pv->f += pv->fs) < pv->fs) {
+            pv->rv = NSHIFT(pv->rv, 16);
+        }
+        if (!held
+            && (pv->adsr += pv->adsrs) + 0x80000000 < pv->adsrz + 0x80000000) {
+            trigger_adsr(pv);
+        }
+        v = pv->adsr >> 16;
+        if (!audible) {
+            v = 0;
+        } else if (v) {
+            v *= doosc(pv);
+        }
+        if (psid->emulatefilter) {
+            pv->filtIO = ampMod1x8[(v >> 22)];
+            dofilter(pv);
+            v = ((uint32_t)(pv->filtIO) + 0x80) << (7 + 15);
+        }
+        o[i] += v;
+    }
+}
+
+static void fastsid_calculate_spans(sound_t *psid, int16_t *pbuf, int nr,
+                                    int interleave)
+{
+    uint32_t o[SPANSIZE];
+    int i, n;
+
+    while (nr > 0) {
+        n = (nr < SPANSIZE) ? nr : SPANSIZE;
+        memset(o, 0, n * sizeof(uint32_t));
+        render_voice_span(psid, &psid->v[0], o, n, 1);
+        render_voice_span(psid, &psid->v[1], o, n, 1);
+        render_voice_span(psid, &psid->v[2], o, n, psid->has3);
+        for (i = 0; i < n; i++) {
+            pbuf[i * interleave] = (int16_t)(((int32_t)(o[i] >> 20) - 0x600) * psid->vol);
+        }
+        pbuf += n * interleave;
+        nr -= n;
+    }
+}
+#endif
+
+static void fastsid_render(sound_t *psid, int16_t *pbuf, int nr, int interleave)
+{
+    int i;
+
+    setup_all(psid);
+#ifdef WAVETABLES
+    if (voices_independent(psid)) {
+        fastsid_calculate_spans(psid, pbuf, nr, interleave);
+        return;
+    }
+#endif
+    for (i = 0; i < nr; i++) {
+        pbuf[i * interleave] = fastsid_calculate_single_sample(psid, i);
+    }
+}
+
 static int fastsid_calculate_samples(sound_t *psid, int16_t *pbuf, int nr,
                                      int interleave, CLOCK *delta_t)
 {
-    int i;
     int16_t *tmp_buf;
 
     if (psid->factor == 1000) {
-        for (i = 0; i < nr; i++) {
-            pbuf[i * interleave] = fastsid_calculate_single_sample(psid, i);
-        }
+        fastsid_render(psid, pbuf, nr, interleave);
         return nr;
     }
     tmp_buf = getbuf(2 * nr * psid->factor / 1000);
-    for (i = 0; i < (nr * psid->factor / 1000); i++) {
-        tmp_buf[i * interleave] = fastsid_calculate_single_sample(psid, i);
-    }
+    fastsid_render(psid, tmp_buf, nr * psid->factor / 1000, interleave);
     memcpy(pbuf, tmp_buf, 2 * nr);
     return nr;
 }
@@ -1059,7 +1149,7 @@ static void fastsid_store(sound_t *psid, uint16_t addr, uint8_t byte)
     psid->d[addr] = byte;
     psid->laststore = byte;
     psid->laststorebit = 8;
-    psid->laststoreclk = maincpu_clk;
+    psid->laststoreclk = sound_store_clk;
 }
 
 static void fastsid_reset(sound_t *psid, CLOCK cpu_clk)
@@ -72,6 +72,7 @@ extern int tape_enabled;
 static log_t sound_log = LOG_ERR;
 
 static void sounddev_close(const sound_device_t **dev);
+static void sound_run_queued_stores(void);
 
 /* ------------------------------------------------------------------------- */
 
@@ -380,6 +381,9 @@ static int set_playback_enabled(int value, void *param)
 {
     int val = value ? 1 : 0;
 
+    /* queued writes belong to the chips as they are now */
+    sound_run_queued_stores();
+
     playback_enabled = val;
     sound_machine_enable(playback_enabled);
     return 0;
@@ -699,6 +703,33 @@ typedef struct {
 
 static snddata_t snddata;
 
+/*
+    Register writes are not passed to the sound chips right away. They are
+    queued with the clock they were made at, and when the sound is next run
+    all chips are brought up to each write in turn before it is applied.
+    This gives the same output as running the sound on every write, without
+    leaving the CPU emulation for each of them.
+
+    Only writes to chips that set queue_stores are queued (SID, VIC, TED).
+    Other chips (drive sound, cartridges) often use the store just to bring
+    the sound up to date and then change their own state directly, so for
+    them the sound is still run right away. Store functions that need the
+    time of the write use sound_store_clk instead of maincpu_clk.
+*/
+#define SOUND_STORE_QUEUE_SIZE 1024
+
+typedef struct sound_store_s {
+    CLOCK clk;
+    uint16_t addr;
+    uint8_t val;
+    uint8_t chipno;
+} sound_store_t;
+
+static sound_store_t store_queue[SOUND_STORE_QUEUE_SIZE];
+static int store_queue_len = 0;
+
+CLOCK sound_store_clk = 0;
+
 /* device registration code */
 #define MAX_SOUND_DEVICES 24
 
@@ -878,6 +909,9 @@ static void sid_close(void)
 
 sound_t *sound_get_psid(unsigned int channel)
 {
+    /* the caller is about to access the chip state directly */
+    sound_run_queued_stores();
+
     return snddata.psid[channel];
 }
 
@@ -1113,6 +1147,8 @@ static void sounddev_close(const sound_device_t **dev)
 /* close sid */
 void sound_close(void)
 {
+    sound_run_queued_stores();
+
     sounddev_close(&snddata.playdev);
     sounddev_close(&snddata.recdev);
     sid_close();
@@ -1137,8 +1173,8 @@ void sound_close(void)
     vsync_suspend_speed_eval();
 }
 
-/* run sid */
-static int sound_run_sound(void)
+/* run sid up to the given clock */
+static void sound_run_sound_until(CLOCK clk)
 {
 #if 1
     static int overflow_warning_count = 0;
@@ -1148,21 +1184,11 @@ static int sound_run_sound(void)
     int i;
     CLOCK delta_t = 0;
     int16_t *bufferptr;
-
-    if (!playback_enabled) {
-        return 1;
-    }
-
-    if (!snddata.playdev) {
-        i = sound_open();
-        if (i) {
-            return i;
-        }
-    }
+    soundclk_t now;
 
     /* Handling of cycle based sound engines. */
     if (cycle_based) {
-        delta_t = maincpu_clk - snddata.lastclk;
+        delta_t = (clk > snddata.lastclk) ? clk - snddata.lastclk : 0;
         bufferptr = snddata.buffer + snddata.bufptr * snddata.sound_output_channels;
         nr = sound_machine_calculate_samples(snddata.psid,
                                              bufferptr,
@@ -1186,12 +1212,20 @@ static int sound_run_sound(void)
             }
 #endif
         }
+
+        /* The engine keeps its own sample clock, follow it closely enough
+           for the DAC step timing. */
+        snddata.fclk += nr * snddata.clkstep;
+        now = SOUNDCLK_CONSTANT(clk);
+        if (snddata.fclk > now || now - snddata.fclk >= snddata.clkstep) {
+            snddata.fclk = now;
+        }
      } else {
          /* Handling of sample based sound engines. */
-         nr = (int)((SOUNDCLK_CONSTANT(maincpu_clk) - snddata.fclk)
+         nr = (int)((SOUNDCLK_CONSTANT(clk) - snddata.fclk)
                     / snddata.clkstep);
-         if (!nr) {
-             return 0;
+         if (nr <= 0) {
+             return;
          }
          if (nr > snddata.bufsize - snddata.bufptr) {
              nr = snddata.bufsize - snddata.bufptr;
@@ -1217,7 +1251,70 @@ static int sound_run_sound(void)
      }
 
     snddata.bufptr += nr;
-    snddata.lastclk = maincpu_clk;
+    snddata.lastclk = clk;
+}
+
+/* pass a register write to the chip and the sound device */
+static void sound_apply_store(uint16_t addr, uint8_t val, int chipno, CLOCK clk)
+{
+    sound_store_clk = clk;
+    sound_machine_store(snddata.psid[chipno], addr, val);
+
+    if (!snddata.playdev->dump) {
+        return;
+    }
+
+    if (snddata.playdev->dump(addr, val, clk - snddata.wclk)) {
+        sound_error("store to sounddevice failed.");
+    }
+
+    snddata.wclk = clk;
+}
+
+/* apply the queued register writes, each at the clock it was made */
+static void sound_run_queued_stores(void)
+{
+    sound_store_t *w;
+    int i;
+
+    if (!store_queue_len) {
+        return;
+    }
+
+    if (!playback_enabled || !snddata.playdev) {
+        /* nothing to apply them to, the chips are gone */
+        store_queue_len = 0;
+        return;
+    }
+
+    for (i = 0; i < store_queue_len; i++) {
+        w = &store_queue[i];
+
+        sound_run_sound_until(w->clk);
+        sound_apply_store(w->addr, w->val, w->chipno, w->clk);
+    }
+
+    store_queue_len = 0;
+}
+
+/* run sid up to the current clock */
+static int sound_run_sound(void)
+{
+    int i;
+
+    if (!playback_enabled) {
+        return 1;
+    }
+
+    if (!snddata.playdev) {
+        i = sound_open();
+        if (i) {
+            return i;
+        }
+    }
+
+    sound_run_queued_stores();
+    sound_run_sound_until(maincpu_clk);
 
 #ifdef __LIBRETRO__
     if (opt_autoloadwarp)
@@ -1232,6 +1329,8 @@ void sound_reset(void)
 {
     int c;
 
+    sound_run_queued_stores();
+
     snddata.fclk = SOUNDCLK_CONSTANT(maincpu_clk);
     snddata.wclk = maincpu_clk;
     snddata.lastclk = maincpu_clk;
@@ -1256,6 +1355,9 @@ bool sound_flush(void)
         goto done;
     }
 
+    /* the device or the chips may be reopened below */
+    sound_run_queued_stores();
+
     if (sound_state_changed) {
         if (sdev_open) {
             sound_close();
@@ -1482,6 +1584,7 @@ int sound_dump(int chipno)
     if (chipno >= snddata.sound_chip_channels) {
         return -1;
     }
+    sound_run_queued_stores();
     mon_out("%s\n", sound_machine_dump_state(snddata.psid[chipno]));
     return 0;
 }
@@ -1501,29 +1604,40 @@ int sound_read(uint16_t addr, int chipno)
 
 void sound_store(uint16_t addr, uint8_t val, int chipno)
 {
-    int i;
+    sound_store_t *w;
 
-    if (sound_run_sound()) {
+    if (!playback_enabled) {
         return;
     }
 
+    if (!snddata.playdev) {
+        if (sound_open()) {
+            return;
+        }
+    }
+
     if (chipno >= snddata.sound_chip_channels) {
         return;
     }
 
-    sound_machine_store(snddata.psid[chipno], addr, val);
-
-    if (!snddata.playdev->dump) {
+    /* not a chip that takes queued writes, see above */
+    if (!sound_calls[addr >> 5]->queue_stores) {
+        if (sound_run_sound()) {
+            return;
+        }
+        sound_apply_store(addr, val, chipno, maincpu_clk);
         return;
     }
 
-    i = snddata.playdev->dump(addr, val, maincpu_clk - snddata.wclk);
-
-    snddata.wclk = maincpu_clk;
-
-    if (i) {
-        sound_error("store to sounddevice failed.");
+    if (store_queue_len == SOUND_STORE_QUEUE_SIZE) {
+        sound_run_queued_stores();
     }
+
+    w = &store_queue[store_queue_len++];
+    w->clk = maincpu_clk;
+    w->addr = addr;
+    w->val = val;
+    w->chipno = (uint8_t)chipno;
 }
 
 
@@ -1581,31 +1695,137 @@ void sound_snapshot_finish(void)
     snddata.lastclk = maincpu_clk;
 }
 
+/* Band-limited steps for the DAC devices, at SOUND_DAC_BLEP_PHASES sub-sample
+   positions. Each entry is the difference between the band-limited and the
+   plain step, to be added on top of the new level. */
+#define SOUND_DAC_BLEP_PHASES 32
+
+static float dac_blep_table[SOUND_DAC_BLEP_PHASES][SOUND_DAC_BLEP_TAPS];
+static int dac_blep_table_done = 0;
+
+static void sound_dac_blep_table_init(void)
+{
+    double integral[(SOUND_DAC_BLEP_TAPS - 1) * SOUND_DAC_BLEP_PHASES + 1];
+    int half = SOUND_DAC_BLEP_TAPS / 2;
+    int steps = (SOUND_DAC_BLEP_TAPS - 1) * SOUND_DAC_BLEP_PHASES;
+    double t, x, sum = 0.0;
+    int i, p, k;
+
+    /* Integrate a Blackman windowed sinc, cut off a bit below half the
+       sample rate, over the length of the step. */
+    integral[0] = 0.0;
+    for (i = 1; i <= steps; i++) {
+        t = ((double)i - 0.5) / SOUND_DAC_BLEP_PHASES - half;
+        x = M_PI * 0.9 * t;
+        sum += (sin(x) / x)
+               * (0.42 + 0.5 * cos(M_PI * t / half) + 0.08 * cos(2.0 * M_PI * t / half));
+        integral[i] = sum;
+    }
+
+    /* Output sample k is k - half samples after a step at phase 0. */
+    for (p = 0; p < SOUND_DAC_BLEP_PHASES; p++) {
+        for (k = 0; k < SOUND_DAC_BLEP_TAPS; k++) {
+            i = k * SOUND_DAC_BLEP_PHASES - p;
+            if (i <= 0) {
+                dac_blep_table[p][k] = -1.0f;
+            } else {
+                dac_blep_table[p][k] = (float)(integral[i] / sum - 1.0);
+            }
+        }
+    }
+
+    dac_blep_table_done = 1;
+}
+
+/* Position of the write being passed to the chip within the next sample. */
+static int sound_dac_phase(void)
+{
+    soundclk_t now = SOUNDCLK_CONSTANT(sound_store_clk);
+    double pos;
+
+    if (!snddata.clkstep || now <= snddata.fclk) {
+        return 0;
+    }
+
+    pos = (double)(now - snddata.fclk) / (double)snddata.clkstep;
+    pos -= (int)pos;
+
+    return (int)(pos * SOUND_DAC_BLEP_PHASES);
+}
+
+static void sound_dac_step(sound_dac_t *dac, int value, int phase)
+{
+    float delta = (float)(value - dac->value);
+    int i, k;
+
+    i = dac->blep_pos;
+    for (k = 0; k < SOUND_DAC_BLEP_TAPS; k++) {
+        dac->blep[i] += delta * dac_blep_table[phase][k];
+        if (++i == SOUND_DAC_BLEP_TAPS) {
+            i = 0;
+        }
+    }
+    dac->value = value;
+    dac->blep_left = SOUND_DAC_BLEP_TAPS;
+}
+
 void sound_dac_init(sound_dac_t *dac, int speed)
 {
+    if (!dac_blep_table_done) {
+        sound_dac_blep_table_init();
+    }
+
     /* 20 dB/Decade high pass filter, cutoff at 5 Hz. For DC offset filtering. */
     dac->alpha = (float)(0.0318309886 / (0.0318309886 + 1.0 / (float)speed));
     dac->value = 0;
+    dac->input = 0.0f;
     dac->output = 0.0;
+    memset(dac->blep, 0, sizeof(dac->blep));
+    dac->blep_pos = 0;
+    dac->blep_left = 0;
+}
+
+/* Set the DAC level from a sound chip store function. The step is placed at
+   the sub-sample position of the write, so it comes out band-limited instead
+   of being snapped to the next sample. */
+void sound_dac_store(sound_dac_t *dac, int value)
+{
+    if (value != dac->value) {
+        sound_dac_step(dac, value, sound_dac_phase());
+    }
 }
 
-/* FIXME: this should use bandlimited step synthesis. Sadly, VICE does not
- * have an easy-to-use infrastructure for blep generation. We should write
- * this code. */
 int sound_dac_calculate_samples(sound_dac_t *dac, int16_t *pbuf, int value, int nr, int soc, int cs)
 {
     int i, sample;
     int off = 0;
+    float input;
+
+    /* A level not passed through sound_dac_store() starts at this buffer. */
+    if (value != dac->value) {
+        sound_dac_step(dac, value, 0);
+    }
+
     /* A simple high pass digital filter is employed here to get rid of the DC offset,
        which would cause distortion when mixed with other signal. This filter is formed
        on the actual hardware by the combination of output decoupling capacitor and load
        resistance.
     */
-    if (nr) {
-        dac->output = dac->alpha * (dac->output + (float)(value - dac->value));
-        dac->value = value;
+    for (i = 0; i < nr; i++) {
+        input = (float)dac->value;
+        if (dac->blep_left) {
+            input += dac->blep[dac->blep_pos];
+            dac->blep[dac->blep_pos] = 0.0f;
+            if (++dac->blep_pos == SOUND_DAC_BLEP_TAPS) {
+                dac->blep_pos = 0;
+            }
+            dac->blep_left--;
+        }
+        dac->output = dac->alpha * (dac->output + input - dac->input);
+        dac->input = input;
         sample = (int)dac->output;
-        if (!sample) {
+        if (!sample && !dac->blep_left) {
+            /* settled, nothing more to add until the next step */
             return nr;
         }
         if (cs & 1) {
@@ -1616,18 +1836,6 @@ int sound_dac_calculate_samples(sound_dac_t *dac, int16_t *pbuf, int value, int
         }
         off += soc;
     }
-
-    for (i = 1; i < nr; i++) {
-        dac->output *= dac->alpha;
-        sample = (int)dac->output;
-        if (cs & 1) {
-            pbuf[off] = sound_audio_mix(pbuf[off], sample);
-        }
-        if (cs & 2) {
-            pbuf[off + 1] = sound_audio_mix(pbuf[off + 1], sample);
-        }
-        off += soc;
-    }
     return nr;
 }
 
@@ -223,6 +223,8 @@ extern int sound_register_device(const sound_device_t *pdevice);
 /* other internal functions used around sound -code */
 extern int sound_read(uint16_t addr, int chipno);
 extern void sound_store(uint16_t addr, uint8_t val, int chipno);
+/* clock of the write being passed to a sound chip store function */
+extern CLOCK sound_store_clk;
 extern long sound_sample_position(void);
 extern int sound_dump(int chipno);
 
@@ -268,17 +270,31 @@ typedef struct sound_chip_s {
     /* sound chip enabled flag */
     int chip_enabled;
 
+    /* writes may be queued until the sound is run, the chip state is only
+       changed through the store function */
+    int queue_stores;
+
 } sound_chip_t;
 
 extern uint16_t sound_chip_register(sound_chip_t *chip);
 
+/* Length of a band-limited step in output samples. The DAC output is
+   delayed by half of it. */
+#define SOUND_DAC_BLEP_TAPS 9
+
 typedef struct sound_dac_s {
     float output;
     float alpha;
     int value;
+    float input;
+    /* corrections of the pending band-limited steps, per output sample */
+    float blep[SOUND_DAC_BLEP_TAPS];
+    int blep_pos;
+    int blep_left;
 } sound_dac_t;
 
 extern void sound_dac_init(sound_dac_t *dac, int speed);
+extern void sound_dac_store(sound_dac_t *dac, int value);
 extern int sound_dac_calculate_samples(sound_dac_t *dac, int16_t *pbuf, int value, int nr, int soc, int cs);
 
 /* recording related functions, equivalent to screenshot_... */
@@ -180,6 +180,7 @@ static int userport_dac_sound_machine_init(sound_t *psid, int speed, int cycles_
 static void userport_dac_sound_machine_store(sound_t *psid, uint16_t addr, uint8_t val)
 {
     snd.voice0 = val;
+    sound_dac_store(&userport_dac_dac, (int)val * 128);
 }
 
 static uint8_t userport_dac_sound_machine_read(sound_t *psid, uint16_t addr)
@@ -77,10 +77,44 @@ static void vdc_write_data(void)
 }
 
 
+/* address translation function for a 64KB VDC in 16KB mode, used by below 2 functions */
+static uint16_t vdc_64k_to_16k_map(uint16_t address)
+{
+    uint16_t new_address = address & 0x80ff;
+    uint16_t tmp = address & 0x3f00;
+    uint16_t low_bit = address & 0x0100;
+
+    tmp <<= 1;
+    tmp |= low_bit;
+    new_address |= tmp;
+    return new_address;
+}
+
+/* Return the offset into vdc.ram for a VDC address, using the same
+   mapping as vdc_ram_read()/vdc_ram_store(). */
+static inline unsigned int vdc_ram_offset(uint16_t addr)
+{
+    addr &= vdc.vdc_address_mask;
+    if (!(vdc.regs[28] & 0x10)) {
+        return vdc_64k_to_16k_map(addr);
+    }
+    return addr;
+}
+
+/* Number of bytes from addr that map to consecutive bytes of vdc.ram.
+   Both the address mask and the 16KB mapping keep the low 8 bits, so a
+   run never crosses a 256 byte page. */
+static inline int vdc_ram_run(uint16_t addr, int len)
+{
+    int run = 0x100 - (addr & 0xff);
+
+    return (run < len) ? run : len;
+}
+
 static void vdc_perform_fillcopy(void)
 {
     int ptr, ptr2;
-    int i;
+    int i, n;
     int blklen;
 
     /* Word count, # of bytes to copy */
@@ -92,9 +126,25 @@ static void vdc_perform_fillcopy(void)
     if (vdc.regs[24] & 0x80) { /* COPY flag */
         /* Block start address.  */
         ptr2 = (vdc.regs[32] << 8) + vdc.regs[33];
-        for (i = 0; i < blklen; i++) {
-            vdc_ram_store((ptr + i),
-                vdc_ram_read(ptr2 + i));
+        for (i = 0; i < blklen; i += n) {
+            uint16_t dst = (uint16_t)(ptr + i);
+            uint16_t src = (uint16_t)(ptr2 + i);
+            uint8_t *d, *s;
+
+            n = vdc_ram_run(src, vdc_ram_run(dst, blklen - i));
+            d = vdc.ram + vdc_ram_offset(dst);
+            s = vdc.ram + vdc_ram_offset(src);
+            if (d <= s || d >= s + n) {
+                memmove(d, s, n);
+            } else {
+                /* overlapping upwards: repeat the pattern like the
+                   VDC does when it copies byte by byte */
+                int j;
+
+                for (j = 0; j < n; j++) {
+                    d[j] = s[j];
+                }
+            }
         }
         ptr2 += blklen;
         vdc.regs[31] = vdc_ram_read(ptr2 - 1);
@@ -107,8 +157,11 @@ static void vdc_perform_fillcopy(void)
         log_message(vdc.log, "Fill mem %04i, len %03i, data %02x",
                     ptr, blklen, vdc.regs[31]);
 #endif
-        for (i = 0; i < blklen; i++) {
-            vdc_ram_store((ptr + i), vdc.regs[31]);
+        for (i = 0; i < blklen; i += n) {
+            uint16_t dst = (uint16_t)(ptr + i);
+
+            n = vdc_ram_run(dst, blklen - i);
+            memset(vdc.ram + vdc_ram_offset(dst), vdc.regs[31], n);
         }
         /* Set the clock for when the vdc status will be clear after this operation */
         vdc_status_clear_clock = maincpu_clk + (blklen*66/100);
@@ -596,19 +649,6 @@ uint8_t vdc_peek(uint16_t addr)    /* No sidefx read of external VDC registers *
     }
 }
 
-/* address translation function for a 64KB VDC in 16KB mode, used by below 2 functions */
-static uint16_t vdc_64k_to_16k_map(uint16_t address)
-{
-    uint16_t new_address = address & 0x80ff;
-    uint16_t tmp = address & 0x3f00;
-    uint16_t low_bit = address & 0x0100;
-
-    tmp <<= 1;
-    tmp |= low_bit;
-    new_address |= tmp;
-    return new_address;
-}
-
 uint8_t vdc_ram_read(uint16_t addr)
 {
     /* Use 16KB memory map when the RAM chip type register #28 bit 4 is 0 for 4416 chips */
@@ -85,7 +85,8 @@ static sound_chip_t sidcart_sound_chip = {
     sid_sound_machine_reset,             /* sound chip reset function */
     sid_sound_machine_cycle_based,       /* sound chip 'is_cycle_based()' function, RESID engine is cycle based, all other engines are NOT */
     sid_sound_machine_channels,          /* sound chip 'get_amount_of_channels()' function, sound chip has 1 channel */
-    0                                    /* sound chip enabled flag, toggled upon device (de-)activation */
+    0,                                   /* sound chip enabled flag, toggled upon device (de-)activation */
+    1                                    /* sound chip writes are queued until the sound is run */
 };
 
 static uint16_t sidcart_sound_chip_offset = 0;
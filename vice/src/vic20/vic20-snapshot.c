@@ -125,6 +125,8 @@ int vic20_snapshot_read(const char *name, int event_mode)
 
     joyport_clear_devices();
 
+    sound_snapshot_prepare();
+
     /* FIXME: Missing sound.  */
     if (maincpu_snapshot_read_module(s) < 0
         || vic20_snapshot_read_module(s) < 0
@@ -71,7 +71,8 @@ static sound_chip_t vic_sound_chip = {
     vic_sound_reset,                     /* sound chip reset function */
     vic_sound_machine_cycle_based,       /* sound chip 'is_cycle_based()' function, chip is NOT cycle based */
     vic_sound_machine_channels,          /* sound chip 'get_amount_of_channels()' function, sound chip has 1 channel */
-    1                                    /* sound chip enabled flag, chip is always enabled */
+    1,                                   /* sound chip enabled flag, chip is always enabled */
+    1                                    /* sound chip writes are queued until the sound is run */
 };
 
 static uint16_t vic_sound_chip_offset = 0;
@@ -334,10 +335,40 @@ void vic_sound_store(uint16_t addr, uint8_t value)
 static uint16_t noise_LFSR = 0x0000;
 static uint8_t noise_LFSR0_old = 0;
 
+/* counter of channel j reached zero: shift the waveform (and the noise
+   LFSR for the noise channel) once */
+static void vic_sound_channel_edge(int j)
+{
+    int enabled = (snd.ch[j].reg & 128) >> 7;
+    int edge_trigger = (noise_LFSR & 1) & !noise_LFSR0_old;
+
+    if ((j != 3) || ((j == 3) && edge_trigger)) {
+        uint8_t shift = snd.ch[j].shift;
+        shift = ((shift << 1) | (((((shift & 128) >> 7)) ^ 1) & enabled));
+        snd.ch[j].shift = shift;
+    }
+    if (j == 3) {
+        int bit3  = (noise_LFSR >> 3) & 1;
+        int bit12 = (noise_LFSR >> 12) & 1;
+        int bit14 = (noise_LFSR >> 14) & 1;
+        int bit15 = (noise_LFSR >> 15) & 1;
+        int gate1 = bit3 ^ bit12;
+        int gate2 = bit14 ^ bit15;
+        int gate3 = (gate1 ^ gate2) ^ 1;
+        int gate4 = (gate3 & enabled) ^ 1;
+        noise_LFSR0_old = noise_LFSR & 1;
+        noise_LFSR = (noise_LFSR << 1) | gate4;
+    }
+    snd.ch[j].out = snd.ch[j].shift & (j == 3 ? enabled : 1);
+}
+
+/* The output of a channel only changes when its counter reaches zero, so
+   instead of stepping every cycle, jump from edge to edge and accumulate
+   the constant output in between. */
 void vic_sound_clock(CLOCK cycles)
 {
-    CLOCK i;
-    int j, enabled;
+    CLOCK left, steps;
+    int j;
 
     if (cycles <= 0) {
         return;
@@ -345,42 +376,26 @@ void vic_sound_clock(CLOCK cycles)
 
     for (j = 0; j < 4; j++) {
         int chspeed = "\4\3\2\1"[j];
+        int a = (~snd.ch[j].reg) & 127;
+        int period;
 
-        if (snd.ch[j].ctr > cycles) {
-            snd.accum += snd.ch[j].out * cycles;
-            snd.ch[j].ctr -= cycles;
-        } else {
-            for (i = cycles; i; i--) {
-                snd.ch[j].ctr--;
-                if (snd.ch[j].ctr <= 0) {
-                    int a = (~snd.ch[j].reg) & 127;
-                    int edge_trigger;
-                    a = a ? a : 128;
-                    snd.ch[j].ctr += a << chspeed;
-                    enabled = (snd.ch[j].reg & 128) >> 7;
-                    edge_trigger = (noise_LFSR & 1) & !noise_LFSR0_old;
+        a = a ? a : 128;
+        period = a << chspeed;
 
-                    if((j != 3) || ((j == 3) && edge_trigger)) {
-                        uint8_t shift = snd.ch[j].shift;
-                        shift = ((shift << 1) | (((((shift & 128) >> 7)) ^ 1) & enabled));
-                        snd.ch[j].shift = shift;
-                    }
-                    if(j == 3) {
-                        int bit3  = (noise_LFSR >> 3) & 1;
-                        int bit12 = (noise_LFSR >> 12) & 1;
-                        int bit14 = (noise_LFSR >> 14) & 1;
-                        int bit15 = (noise_LFSR >> 15) & 1;
-                        int gate1 = bit3 ^ bit12;
-                        int gate2 = bit14 ^ bit15;
-                        int gate3 = (gate1 ^ gate2) ^ 1;
-                        int gate4 = (gate3 & enabled) ^ 1;
-                        noise_LFSR0_old = noise_LFSR & 1;
-                        noise_LFSR = (noise_LFSR << 1) | gate4;
-                    }
-                    snd.ch[j].out = snd.ch[j].shift & (j == 3 ? enabled : 1);
-                }
-                snd.accum += snd.ch[j].out; /* FIXME: doesn't take DC offset into account */
+        for (left = cycles; left; left -= steps) {
+            if (snd.ch[j].ctr > left) {
+                snd.accum += snd.ch[j].out * left; /* FIXME: doesn't take DC offset into account */
+                snd.ch[j].ctr -= left;
+                break;
             }
+
+            /* the counter reaches zero on cycle 'steps' of the remaining ones */
+            steps = (snd.ch[j].ctr > 0) ? snd.ch[j].ctr : 1;
+            snd.accum += snd.ch[j].out * (steps - 1);
+            snd.ch[j].ctr -= steps;
+            snd.ch[j].ctr += period;
+            vic_sound_channel_edge(j);
+            snd.accum += snd.ch[j].out;
         }
     }
 
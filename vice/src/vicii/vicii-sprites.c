@@ -410,16 +410,24 @@ static void init_drawing_tables(void)
         (collmskptr)[(pos)] |= (sprite_bit);                  \
     } while (0)
 
-/* Hires sprites */
+/* Hires sprites. The loop ends as soon as no pixel is left in the mask
+   and steps over fully transparent groups of 8 pixels at once.  */
 #define _SPRITE_MASK(msk, gfxmsk, size, sprite_bit, imgptr,      \
                      collmskptr, color, collmsk_return, DRAW)    \
     do {                                                         \
         uint32_t __m;                                               \
         int __p;                                                 \
                                                                  \
-        for (__m = 1 << ((size) - 1), __p = 0;                   \
-             __p < (size);                                       \
+        for (__m = 1U << ((size) - 1), __p = 0;                  \
+             __p < (size) && ((msk) & (__m | (__m - 1)));        \
              __p++, __m >>= 1) {                                 \
+            if (__m >= 0x80                                      \
+                && !((msk) & (__m | (__m - 1))                   \
+                     & ~((__m >> 7) - 1))) {                     \
+                __p += 7;                                        \
+                __m >>= 7;                                       \
+                continue;                                        \
+            }                                                    \
             if ((msk) & __m) {                                   \
                 if ((gfxmsk) & __m) {                            \
                     DRAW(0, sprite_bit, imgptr, collmskptr, __p, \
@@ -436,7 +444,8 @@ static void init_drawing_tables(void)
     _SPRITE_MASK(msk, gfxmsk, size, sprite_bit, imgptr, collmskptr, \
                  color, collmsk_return, SPRITE_PIXEL)
 
-/* Multicolor sprites */
+/* Multicolor sprites. Only bits 23..0 of mcmsk are ever displayed, so
+   the loop ends once they are all transparent.  */
 #define _MCSPRITE_MASK(mcmsk, gfxmsk, trmsk, size, sprite_bit, imgptr,   \
                        collmskptr, pixel_table, collmsk_return, DRAW)    \
     do {                                                                 \
@@ -444,7 +453,7 @@ static void init_drawing_tables(void)
         int __p;                                                         \
                                                                          \
         for (__m = 1 << ((size) - 1), __p = 0;                           \
-             __p < (size);                                               \
+             __p < (size) && ((mcmsk) & 0xffffff);                       \
              __p += 2, __m >>= 2, (mcmsk) <<= 2, (trmsk) <<= 2) {        \
             uint8_t __c, __t;                                               \
                                                                          \
@@ -490,7 +499,8 @@ static void init_drawing_tables(void)
         uint32_t __m;                                                    \
         int __p, __i;                                                 \
                                                                       \
-        for (__m = 1U << ((size) - 1), __p = 0; __p < (size);         \
+        for (__m = 1U << ((size) - 1), __p = 0;                       \
+             __p < (size) && ((mcmsk) & 0xffffff);                    \
              __p += 4, (mcmsk) <<= 2, (trmsk) <<= 4) {                \
             uint8_t __c;                                                 \
             uint8_t __t;                                                 \